@@ -34,6 +34,10 @@ void AAStarController::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	StepTimeSlicedSearches(TimeSliceBudgetMicroseconds, TimeSliceMaxExpansions);
+
+	// Other systems may have grown past the budget since the last query
+	PathCache.TrimToBudget();
 }
 
 float AAStarController::MovementCostBetween(int32 AIndex, int32 BIndex) const
@@ -50,6 +54,17 @@ float AAStarController::MovementCostBetween(int32 AIndex, int32 BIndex) const
 }
 
 TArray<FVector> AAStarController::FindPath(const FVector& StartWorld, const FVector& GoalWorld)
+{
+	return FindPathWithMode(StartWorld, GoalWorld, DefaultSearchMode, DefaultEpsilon);
+}
+
+TArray<FVector> AAStarController::FindPathForRadius(const FVector& StartWorld, const FVector& GoalWorld, float UnitRadius)
+{
+	return FindPathWithMode(StartWorld, GoalWorld, DefaultSearchMode, DefaultEpsilon, UnitRadius);
+}
+
+TArray<FVector> AAStarController::FindPathWithMode(const FVector& StartWorld, const FVector& GoalWorld, EAStarSearchMode Mode, float Epsilon,
+	float UnitRadius)
 {
 	// Convert to grid space
 	FIntPoint StartCell = GridManager->WorldToCell(StartWorld);
@@ -67,14 +82,11 @@ TArray<FVector> AAStarController::FindPath(const FVector& StartWorld, const FVec
 	}
 
 	// Run the A* core (this part can stay private, taking FIntPoints)
-	TArray<FIntPoint> CellPath = RunAStar(StartCell, GoalCell);
+	const int32 MinClearance = UnitRadius > 0.f ? GridManager->RadiusToClearance(UnitRadius) : 0;
+	TArray<FIntPoint> CellPath = RunAStar(StartCell, GoalCell, Mode, Epsilon, MinClearance);
 
 	// Convert back to world space
-	TArray<FVector> WorldPath;
-	for (const FIntPoint& Cell : CellPath)
-	{
-		WorldPath.Add(GridManager->CellToWorld(Cell));
-	}
+	TArray<FVector> WorldPath = FinishPath(CellPath, UnitRadius);
 
 	// Optional debug draw
 	if (GridManager->bDrawDebug && GridManager->bDrawAStarPath)
@@ -109,127 +121,365 @@ TArray<FVector> AAStarController::FindPath(const FVector& StartWorld, const FVec
 	return WorldPath;
 }
 
-TArray<FIntPoint> AAStarController::RunAStar(const FIntPoint& StartCell, const FIntPoint& GoalCell)
+TArray<FIntPoint> AAStarController::RunAStar(const FIntPoint& StartCell, const FIntPoint& GoalCell,
+	EAStarSearchMode Mode, float Epsilon, int32 MinClearance)
 {
     TArray<FIntPoint> ResultPath;
 
-    // Validate cells in-bounds
-    if (!GridManager->IsInside(StartCell.X, StartCell.Y) || !GridManager->IsInside(GoalCell.X, GoalCell.Y))
-    {
-        return ResultPath;
-    }
-
-    const int32 StartIdx = GridManager->XYToIndex(StartCell.X, StartCell.Y);
-    const int32 GoalIdx  = GridManager->XYToIndex(GoalCell.X, GoalCell.Y);
+    // The bidirectional search has no clearance filter or occupancy term
+    const bool bCanRunBidirectional = MinClearance <= 1 && OccupancyWeight <= 0.f;
+    if (Mode == EAStarSearchMode::Bidirectional && !bCanRunBidirectional) Mode = EAStarSearchMode::Optimal;
 
-    // Validate walkability (-1 means blocked)
-    if (!GridManager->Grid.IsValidIndex(StartIdx) || !GridManager->Grid.IsValidIndex(GoalIdx) ||
-        GridManager->Grid[StartIdx].Cost < 0 || GridManager->Grid[GoalIdx].Cost < 0)
+    // Long optimal queries go bidirectional when enabled
+    if (Mode == EAStarSearchMode::Optimal && BidirectionalMinDistance > 0 && bCanRunBidirectional &&
+        FMath::Max(FMath::Abs(StartCell.X - GoalCell.X), FMath::Abs(StartCell.Y - GoalCell.Y)) >= BidirectionalMinDistance)
     {
-        return ResultPath;
+        Mode = EAStarSearchMode::Bidirectional;
     }
 
-    const int32 NumNodes = GridManager->GridWidth * GridManager->GridHeight;
+    PathCache.SetMaxEntries(PathCacheSize);
+    const bool bUseCache = PathCacheSize > 0 && OccupancyWeight <= 0.f;
+
+    FPathCacheKey CacheKey;
+    CacheKey.Start = StartCell;
+    CacheKey.Goal = GoalCell;
+    CacheKey.Mode = (uint8)Mode;
+    CacheKey.Epsilon = Mode == EAStarSearchMode::Weighted || Mode == EAStarSearchMode::Focal ? Epsilon : 0.f;
+    CacheKey.MinClearance = MinClearance;
+    CacheKey.DiagonalCost = DiagonalCost;
+    CacheKey.bUseLandmarks = bUseLandmarkHeuristic;
 
-    // Search buffers
-    TArray<FSearchNode> SearchNodes;
-    SearchNodes.SetNum(NumNodes);
-    for (int32 i = 0; i < NumNodes; ++i)
+    // The bidirectional search always runs on heaps
+    if (Mode != EAStarSearchMode::Bidirectional)
     {
-        SearchNodes[i].G = TNumericLimits<float>::Max();
-        SearchNodes[i].H = 0.f;
-        SearchNodes[i].F = TNumericLimits<float>::Max();
-        SearchNodes[i].Parent = -1;
-        SearchNodes[i].bClosed = false;
+        CacheKey.OpenList = (uint8)OpenListType;
+        CacheKey.BucketWidth = OpenListType == EPathOpenListType::BucketQueue ? BucketWidth : 0.f;
     }
 
-    FBinaryHeapOpenSet OpenSet;
-    OpenSet.ReservePos(NumNodes);
-    OpenSet.Init(NumNodes);
-
-    // Octile heuristic (admissible/consistent for 8-way with DiagonalCost)
-    auto Heuristic = [&](int32 A, int32 B) -> float
-    {
-        int32 Ax, Ay, Bx, By;
-        IndexToXY(A, Ax, Ay);
-        IndexToXY(B, Bx, By);
-        const int32 Dx = FMath::Abs(Ax - Bx);
-        const int32 Dy = FMath::Abs(Ay - By);
-        const float F  = float(FMath::Min(Dx, Dy));
-        return float(FMath::Max(Dx, Dy) - F) + DiagonalCost * F;
-    };
-
-    // Initialize start
-    SearchNodes[StartIdx].G = 0.f;
-    SearchNodes[StartIdx].H = Heuristic(StartIdx, GoalIdx);
-    SearchNodes[StartIdx].F = SearchNodes[StartIdx].H; // G=0 so F=H
-    OpenSet.Push(StartIdx, SearchNodes[StartIdx].F);
-
-    bool bFound = false;
-
-    while (!OpenSet.IsEmpty())
+    if (bUseCache)
     {
-        const int32 Curr = OpenSet.PopMin();
-        if (Curr == -1) break;
-
-        if (Curr == GoalIdx)
-        {
-            bFound = true;
-            break;
-        }
-
-        // Mark closed
-        SearchNodes[Curr].bClosed = true;
-
-    	int32 CurrX, CurrY;
-    	IndexToXY(Curr, CurrX, CurrY);
-    	
-        // Expand neighbors
-        const TArray<const FGridCell*> Neighbors = GridManager->GetNeighbors(CurrX, CurrY);
-        for (const FGridCell* NbCell : Neighbors)
+        if (const TArray<FIntPoint>* Cached = PathCache.Find(CacheKey, GridManager->GetGridVersion()))
         {
-			const int32 Nb = GridManager->XYToIndex(NbCell->X, NbCell->Y);
-        	
-            if (SearchNodes[Nb].bClosed) continue;
-
-            // Terrain cost (>=1 for walkable; -1 means blocked, but we filtered earlier)
-            const float TerrainCost = (GridManager->Grid.IsValidIndex(Nb) ? FMath::Max(1, GridManager->Grid[Nb].Cost) : 1);
-            const float MoveCost    = MovementCostBetween(Curr, Nb);
-            const float TentativeG  = SearchNodes[Curr].G + MoveCost * TerrainCost;
-
-            if (TentativeG < SearchNodes[Nb].G)
-            {
-                SearchNodes[Nb].Parent = Curr;
-                SearchNodes[Nb].G = TentativeG;
-                SearchNodes[Nb].H = Heuristic(Nb, GoalIdx);
-                SearchNodes[Nb].F = SearchNodes[Nb].G + SearchNodes[Nb].H;
-
-                OpenSet.PushOrDecrease(Nb, SearchNodes[Nb].F);
-            }
+            SearchStats.FindOrAdd(Mode).CacheHits++;
+            return *Cached;
         }
     }
 
-    // Reconstruct path (grid-space)
-    if (bFound)
+    if (Mode == EAStarSearchMode::Bidirectional)
     {
-        TArray<int32> PathIdx;
-        PathIdx.Reserve(64);
-        int32 Trace = GoalIdx;
-        while (Trace != -1)
-        {
-            PathIdx.Add(Trace);
-            Trace = SearchNodes[Trace].Parent;
-        }
-        Algo::Reverse(PathIdx);
+        int32 NodesExpanded = 0;
+        float PathCost = -1.f;
+        const double StartTime = FPlatformTime::Seconds();
+        const bool bFound = FAStarSearch::RunBidirectional(GridManager, StartCell, GoalCell, DiagonalCost, bUseLandmarkHeuristic,
+            ResultPath, NodesExpanded, PathCost);
+        RecordSearchStats(Mode, bFound, NodesExpanded, PathCost, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+        if (bUseCache) PathCache.Add(CacheKey, GridManager->GetGridVersion(), ResultPath);
+        return ResultPath;
+    }
 
-        ResultPath.Reserve(PathIdx.Num());
-        for (const int32 Idx : PathIdx)
-        {
-            int32 X, Y;
-            IndexToXY(Idx, X, Y);
-            ResultPath.Add(FIntPoint(X, Y));
-        }
+    // Same search the time-sliced path uses, just run to completion in one go
+    FAStarSearch Search;
+    if (!Search.Init(GridManager, StartCell, GoalCell, DiagonalCost, MakeSearchParams(Mode, Epsilon, MinClearance)))
+    {
+        return ResultPath;
     }
 
+    const double StartTime = FPlatformTime::Seconds();
+    Search.Step();
+    RecordSearchStats(Mode, Search, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+    Search.GetPath(ResultPath);
+
+    if (bUseCache) PathCache.Add(CacheKey, GridManager->GetGridVersion(), ResultPath);
     return ResultPath;
-}
\ No newline at end of file
+}
+
+void AAStarController::ClearPathCache()
+{
+    PathCache.Empty();
+}
+
+TArray<FIntPoint> AAStarController::RunAStarMultiGoal(const FIntPoint& StartCell, const TArray<FIntPoint>& GoalCells, FIntPoint& OutReachedGoal,
+	EAStarSearchMode Mode, float Epsilon)
+{
+	TArray<FIntPoint> ResultPath;
+	OutReachedGoal = FIntPoint(-1, -1);
+
+	// Bidirectional needs a single goal, fall back to a plain optimal search
+	if (Mode == EAStarSearchMode::Bidirectional) Mode = EAStarSearchMode::Optimal;
+
+	FAStarSearch Search;
+	if (!Search.InitMultiGoal(GridManager, StartCell, GoalCells, DiagonalCost, MakeSearchParams(Mode, Epsilon)))
+	{
+		return ResultPath;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	Search.Step();
+	RecordSearchStats(Mode, Search, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	if (Search.GetPath(ResultPath))
+	{
+		OutReachedGoal = Search.GetGoalCell();
+	}
+
+	return ResultPath;
+}
+
+TArray<FVector> AAStarController::FindPathToNearest(const FVector& StartWorld, const TArray<FVector>& GoalWorlds, int32& OutGoalIndex)
+{
+	OutGoalIndex = -1;
+	if (!GridManager || GoalWorlds.Num() == 0) return {};
+
+	const FIntPoint StartCell = GridManager->WorldToCell(StartWorld);
+
+	TArray<FIntPoint> GoalCells;
+	GoalCells.Reserve(GoalWorlds.Num());
+	for (const FVector& Goal : GoalWorlds)
+	{
+		GoalCells.Add(GridManager->WorldToCell(Goal));
+	}
+
+	FIntPoint ReachedGoal;
+	const TArray<FIntPoint> CellPath = RunAStarMultiGoal(StartCell, GoalCells, ReachedGoal, DefaultSearchMode, DefaultEpsilon);
+	if (CellPath.Num() == 0) return {};
+
+	OutGoalIndex = GoalCells.IndexOfByKey(ReachedGoal);
+	return FinishPath(CellPath);
+}
+
+TArray<FCooperativePath> AAStarController::FindGroupPathsCooperative(const TArray<FVector>& StartWorlds, const FVector& GoalWorld)
+{
+	TArray<FCooperativePath> Result;
+	Result.SetNum(StartWorlds.Num());
+	if (!GridManager) return Result;
+
+	TArray<FIntPoint> StartCells;
+	StartCells.Reserve(StartWorlds.Num());
+	for (const FVector& StartWorld : StartWorlds)
+	{
+		StartCells.Add(GridManager->WorldToCell(StartWorld));
+	}
+
+	FCooperativePathParams Params;
+	Params.Window = CooperativeWindow;
+	Params.MaxRounds = CooperativeMaxRounds;
+	Params.DiagonalCost = DiagonalCost;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FCooperativeAgentPath> AgentPaths;
+	FCooperativePlanStats Stats;
+	FCooperativePathfinder::PlanGroup(GridManager->MakeCostField(), StartCells, GridManager->WorldToCell(GoalWorld), Params, AgentPaths, &Stats);
+
+	UE_LOG(LogTemp, Verbose, TEXT("AStar cooperative: %d units, %d rounds, %d conflicts, %d sequential, %lld nodes, %.3f ms"),
+		StartWorlds.Num(), Stats.Rounds, Stats.Conflicts, Stats.SequentialAgents, Stats.NodesExpanded,
+		(FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	for (int32 i = 0; i < AgentPaths.Num(); i++)
+	{
+		Result[i].Points = CellPathToWorld(AgentPaths[i].Cells);
+		Result[i].Steps = MoveTemp(AgentPaths[i].Steps);
+		Result[i].bFound = AgentPaths[i].bFound;
+	}
+
+	return Result;
+}
+
+FAStarSearchParams AAStarController::MakeSearchParams(EAStarSearchMode Mode, float Epsilon, int32 MinClearance) const
+{
+	FAStarSearchParams Params;
+	Params.MinClearance = MinClearance;
+	Params.OccupancyWeight = OccupancyWeight;
+	Params.bUseLandmarks = bUseLandmarkHeuristic;
+	Params.OpenList = OpenListType;
+	Params.BucketWidth = BucketWidth;
+	Epsilon = FMath::Max(0.f, Epsilon);
+
+	switch (Mode)
+	{
+	case EAStarSearchMode::Weighted:
+		Params.HeuristicWeight = 1.f + Epsilon;
+		break;
+	case EAStarSearchMode::Focal:
+		Params.FocalEpsilon = Epsilon;
+		break;
+	default:
+		break;
+	}
+
+	return Params;
+}
+
+void AAStarController::RecordSearchStats(EAStarSearchMode Mode, const FAStarSearch& Search, double Milliseconds)
+{
+	RecordSearchStats(Mode, Search.GetStatus() == EAStarSearchStatus::Found, Search.GetNodesExpanded(), Search.GetPathCost(), Milliseconds);
+}
+
+void AAStarController::RecordSearchStats(EAStarSearchMode Mode, bool bFound, int32 NodesExpanded, float PathCost, double Milliseconds)
+{
+	FAStarModeStats& Stats = SearchStats.FindOrAdd(Mode);
+	Stats.Queries++;
+	Stats.NodesExpanded += NodesExpanded;
+	Stats.TotalMilliseconds += Milliseconds;
+
+	if (bFound)
+	{
+		Stats.PathsFound++;
+		Stats.TotalPathCost += PathCost;
+	}
+}
+
+FAStarModeStats AAStarController::GetSearchStats(EAStarSearchMode Mode) const
+{
+	const FAStarModeStats* Stats = SearchStats.Find(Mode);
+	return Stats ? *Stats : FAStarModeStats();
+}
+
+void AAStarController::ResetSearchStats()
+{
+	SearchStats.Empty();
+}
+
+void AAStarController::LogSearchStats() const
+{
+	for (const TPair<EAStarSearchMode, FAStarModeStats>& Pair : SearchStats)
+	{
+		const FAStarModeStats& Stats = Pair.Value;
+		if (Stats.Queries == 0 && Stats.CacheHits == 0) continue;
+
+		UE_LOG(LogTemp, Log, TEXT("AStar %s: %d queries, %d found, %.1f nodes/query, %.2f cost/path, %.3f ms/query, %d cache hits"),
+			*UEnum::GetValueAsString(Pair.Key),
+			Stats.Queries,
+			Stats.PathsFound,
+			double(Stats.NodesExpanded) / FMath::Max(1, Stats.Queries),
+			Stats.PathsFound > 0 ? Stats.TotalPathCost / Stats.PathsFound : 0.0,
+			Stats.TotalMilliseconds / FMath::Max(1, Stats.Queries),
+			Stats.CacheHits);
+	}
+}
+
+TArray<FVector> AAStarController::CellPathToWorld(const TArray<FIntPoint>& CellPath) const
+{
+	TArray<FVector> WorldPath;
+	WorldPath.Reserve(CellPath.Num());
+	for (const FIntPoint& Cell : CellPath)
+	{
+		WorldPath.Add(GridManager->CellToWorld(Cell));
+	}
+	return WorldPath;
+}
+
+TArray<FVector> AAStarController::FinishPath(const TArray<FIntPoint>& CellPath, float UnitRadius)
+{
+	TArray<FVector> WorldPath = CellPathToWorld(CellPath);
+	GridManager->PostProcessPath(WorldPath, PathPostProcess, UnitRadius);
+	return WorldPath;
+}
+
+int32 AAStarController::RequestPathTimeSliced(const FVector& StartWorld, const FVector& GoalWorld)
+{
+	return RequestPathTimeSlicedWithMode(StartWorld, GoalWorld, DefaultSearchMode, DefaultEpsilon);
+}
+
+int32 AAStarController::RequestPathTimeSlicedWithMode(const FVector& StartWorld, const FVector& GoalWorld, EAStarSearchMode Mode, float Epsilon)
+{
+	if (!GridManager) return -1;
+
+	const FIntPoint StartCell = GridManager->WorldToCell(StartWorld);
+	const FIntPoint GoalCell  = GridManager->WorldToCell(GoalWorld);
+
+	// Bidirectional search isn't resumable, time-sliced requests run it as plain A*
+	if (Mode == EAStarSearchMode::Bidirectional) Mode = EAStarSearchMode::Optimal;
+
+	FTimeSlicedRequest Request;
+	Request.Search = MakeUnique<FAStarSearch>();
+	Request.Mode = Mode;
+	if (!Request.Search->Init(GridManager, StartCell, GoalCell, DiagonalCost, MakeSearchParams(Mode, Epsilon)))
+	{
+		return -1;
+	}
+
+	const int32 RequestId = NextRequestId++;
+	TimeSlicedSearches.Add(RequestId, MoveTemp(Request));
+	TimeSlicedQueue.Add(RequestId);
+	return RequestId;
+}
+
+EAStarRequestState AAStarController::GetTimeSlicedPath(int32 RequestId, TArray<FVector>& OutPath, bool bAllowPartial)
+{
+	OutPath.Reset();
+
+	const FTimeSlicedRequest* Found = TimeSlicedSearches.Find(RequestId);
+	if (!Found || !GridManager) return EAStarRequestState::Invalid;
+
+	const FAStarSearch& Search = *Found->Search;
+	TArray<FIntPoint> CellPath;
+
+	switch (Search.GetStatus())
+	{
+	case EAStarSearchStatus::Found:
+		Search.GetPath(CellPath);
+		OutPath = FinishPath(CellPath);
+		CancelTimeSlicedPath(RequestId);
+		return EAStarRequestState::Succeeded;
+
+	case EAStarSearchStatus::InProgress:
+		if (bAllowPartial && Search.GetBestPartialPath(CellPath))
+		{
+			OutPath = FinishPath(CellPath);
+		}
+		return EAStarRequestState::InProgress;
+
+	default:
+		// Hand back whatever got closest so the unit is not left standing still
+		if (bAllowPartial && Search.GetBestPartialPath(CellPath))
+		{
+			OutPath = FinishPath(CellPath);
+		}
+		CancelTimeSlicedPath(RequestId);
+		return EAStarRequestState::Failed;
+	}
+}
+
+void AAStarController::CancelTimeSlicedPath(int32 RequestId)
+{
+	TimeSlicedSearches.Remove(RequestId);
+	TimeSlicedQueue.Remove(RequestId);
+}
+
+void AAStarController::StepTimeSlicedSearches(double BudgetMicroseconds, int32 MaxExpansions)
+{
+	if (TimeSlicedQueue.Num() == 0) return;
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 ExpansionsLeft = MaxExpansions;
+
+	// Oldest requests first so nothing starves; finished ones wait in the map until fetched
+	for (int32 i = 0; i < TimeSlicedQueue.Num(); )
+	{
+		FTimeSlicedRequest& Request = TimeSlicedSearches.FindChecked(TimeSlicedQueue[i]);
+		FAStarSearch& Search = *Request.Search;
+
+		const double StepStart = FPlatformTime::Seconds();
+		const double TimeLeft = BudgetMicroseconds - (StepStart - StartTime) * 1e6;
+		if (BudgetMicroseconds > 0.0 && TimeLeft <= 0.0) break;
+		if (MaxExpansions > 0 && ExpansionsLeft <= 0) break;
+
+		const int32 ExpandedBefore = Search.GetNodesExpanded();
+		Search.Step(MaxExpansions > 0 ? ExpansionsLeft : 0, BudgetMicroseconds > 0.0 ? TimeLeft : 0.0);
+		ExpansionsLeft -= Search.GetNodesExpanded() - ExpandedBefore;
+		Request.Milliseconds += (FPlatformTime::Seconds() - StepStart) * 1000.0;
+
+		if (Search.IsDone())
+		{
+			RecordSearchStats(Request.Mode, Search, Request.Milliseconds);
+			TimeSlicedQueue.RemoveAt(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
@@ -2,9 +2,78 @@
 
 #include "CoreMinimal.h"
 #include "GridManager.h"
+#include "AStarSearch.h"
+#include "CooperativePathfinder.h"
+#include "PathCache.h"
 #include "GameFramework/Actor.h"
 #include "AStarController.generated.h"
 
+UENUM(BlueprintType)
+enum class EAStarRequestState : uint8
+{
+	Invalid,
+	InProgress,
+	Succeeded,
+	Failed
+};
+
+UENUM(BlueprintType)
+enum class EAStarSearchMode : uint8
+{
+	// Plain A*, always returns an optimal path
+	Optimal,
+	// Heuristic inflated by (1 + Epsilon), no reopening
+	Weighted,
+	// Focal search, expands the node closest to the goal within (1 + Epsilon) of the best F
+	Focal,
+	// Optimal bidirectional A*, meant for long single-goal queries (Epsilon is ignored)
+	Bidirectional
+};
+
+// Running totals per search mode, used to tune epsilon per unit type
+USTRUCT(BlueprintType)
+struct FAStarModeStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	int32 Queries = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	int32 PathsFound = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	int64 NodesExpanded = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	double TotalPathCost = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	double TotalMilliseconds = 0.0;
+
+	// RunAStar calls answered from the path cache. They ran no search, so they aren't in the
+	// fields above.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="AStar|Stats")
+	int32 CacheHits = 0;
+};
+
+// One unit's path from a cooperative group plan. Steps[i] is the time step the unit
+// should reach Points[i]; gaps between steps mean "wait here".
+USTRUCT(BlueprintType)
+struct FCooperativePath
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="AStar|Cooperative")
+	TArray<FVector> Points;
+
+	UPROPERTY(BlueprintReadOnly, Category="AStar|Cooperative")
+	TArray<int32> Steps;
+
+	UPROPERTY(BlueprintReadOnly, Category="AStar|Cooperative")
+	bool bFound = false;
+};
+
 UCLASS()
 class MASSIVE_API AAStarController : public AActor
 {
@@ -22,7 +91,121 @@ public:
 	UFUNCTION(BlueprintCallable, Category="AStar")
 	TArray<FVector> FindPath(const FVector& StartWorld, const FVector& GoalWorld);
 
-	TArray<FIntPoint> RunAStar(const FIntPoint& StartCell, const FIntPoint& GoalCell);
+	// Mode and epsilon used by FindPath and time-sliced requests that don't pass their own
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|Suboptimal")
+	EAStarSearchMode DefaultSearchMode = EAStarSearchMode::Optimal;
+
+	// Maximum relative path-length overhead for Weighted/Focal, e.g. 0.1 = at most 10% longer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|Suboptimal", meta=(ClampMin="0.0"))
+	float DefaultEpsilon = 0.1f;
+
+	// UnitRadius > 0 keeps the path on cells with enough clearance for a unit of that size
+	UFUNCTION(BlueprintCallable, Category="AStar|Suboptimal")
+	TArray<FVector> FindPathWithMode(const FVector& StartWorld, const FVector& GoalWorld, EAStarSearchMode Mode, float Epsilon = 0.1f,
+		float UnitRadius = 0.f);
+
+	// FindPath for a unit that doesn't fit through every gap
+	UFUNCTION(BlueprintCallable, Category="AStar")
+	TArray<FVector> FindPathForRadius(const FVector& StartWorld, const FVector& GoalWorld, float UnitRadius);
+
+	// FindPath switches Optimal queries to bidirectional A* once start and goal are at least
+	// this many cells apart (0 = never). Not while OccupancyWeight or a clearance is in use,
+	// which the bidirectional search doesn't support.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar", meta=(ClampMin="0"))
+	int32 BidirectionalMinDistance = 0;
+
+	TArray<FIntPoint> RunAStar(const FIntPoint& StartCell, const FIntPoint& GoalCell,
+		EAStarSearchMode Mode = EAStarSearchMode::Optimal, float Epsilon = 0.f, int32 MinClearance = 0);
+
+	// Path to whichever goal is cheapest to reach, found with a single search.
+	// OutGoalIndex is the index into GoalWorlds of the goal that was reached (-1 if none).
+	UFUNCTION(BlueprintCallable, Category="AStar")
+	TArray<FVector> FindPathToNearest(const FVector& StartWorld, const TArray<FVector>& GoalWorlds, int32& OutGoalIndex);
+
+	TArray<FIntPoint> RunAStarMultiGoal(const FIntPoint& StartCell, const TArray<FIntPoint>& GoalCells, FIntPoint& OutReachedGoal,
+		EAStarSearchMode Mode = EAStarSearchMode::Optimal, float Epsilon = 0.f);
+
+	// Use the grid manager's ALT landmarks (if built) to tighten the heuristic
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar")
+	bool bUseLandmarkHeuristic = true;
+
+	// Extra cost per unit standing on a cell, so paths bend around stationary crowds (0 = ignore occupancy)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar", meta=(ClampMin="0.0"))
+	float OccupancyWeight = 0.f;
+
+	// String pulling / smoothing applied to every world-space path this controller returns
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|PostProcess")
+	FPathPostProcessSettings PathPostProcess;
+
+	// Priority queue for the open list. The bucket queue is exact only when all costs
+	// (terrain and DiagonalCost) are multiples of BucketWidth, otherwise paths can cost up
+	// to BucketWidth more than optimal.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|OpenList")
+	EPathOpenListType OpenListType = EPathOpenListType::QuaternaryHeap;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|OpenList", meta=(ClampMin="0.01", EditCondition="OpenListType==EPathOpenListType::BucketQueue"))
+	float BucketWidth = 1.f;
+
+	// RunAStar results kept per start, goal and settings until the grid changes (0 = no cache).
+	// Skipped while OccupancyWeight is set, since occupancy changes every frame.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|Cache", meta=(ClampMin="0"))
+	int32 PathCacheSize = 64;
+
+	UFUNCTION(BlueprintCallable, Category="AStar|Cache")
+	void ClearPathCache();
+
+	FAStarSearchParams MakeSearchParams(EAStarSearchMode Mode, float Epsilon, int32 MinClearance = 0) const;
+
+	UFUNCTION(BlueprintPure, Category="AStar|Stats")
+	FAStarModeStats GetSearchStats(EAStarSearchMode Mode) const;
+
+	UFUNCTION(BlueprintCallable, Category="AStar|Stats")
+	void ResetSearchStats();
+
+	// Prints average nodes expanded, path cost and time per mode
+	UFUNCTION(BlueprintCallable, Category="AStar|Stats")
+	void LogSearchStats() const;
+
+	// Time-sliced searches are stepped in Tick and share this budget per frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|TimeSlicing", meta=(ClampMin="0.0"))
+	float TimeSliceBudgetMicroseconds = 1000.f;
+
+	// Optional cap on node expansions per frame (0 = only the time budget applies)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|TimeSlicing", meta=(ClampMin="0"))
+	int32 TimeSliceMaxExpansions = 0;
+
+	// Queues a search that is spread over several frames. Returns a request id, or -1 if the cells are invalid.
+	UFUNCTION(BlueprintCallable, Category="AStar|TimeSlicing")
+	int32 RequestPathTimeSliced(const FVector& StartWorld, const FVector& GoalWorld);
+
+	UFUNCTION(BlueprintCallable, Category="AStar|TimeSlicing")
+	int32 RequestPathTimeSlicedWithMode(const FVector& StartWorld, const FVector& GoalWorld, EAStarSearchMode Mode, float Epsilon = 0.1f);
+
+	// Fetches the current result of a time-sliced request. With bAllowPartial the best path found
+	// so far is returned while the search is still running, so units can start moving right away.
+	// Finished requests are released once their result has been fetched.
+	UFUNCTION(BlueprintCallable, Category="AStar|TimeSlicing")
+	EAStarRequestState GetTimeSlicedPath(int32 RequestId, TArray<FVector>& OutPath, bool bAllowPartial = true);
+
+	UFUNCTION(BlueprintCallable, Category="AStar|TimeSlicing")
+	void CancelTimeSlicedPath(int32 RequestId);
+
+	// Steps pending time-sliced searches within the given budget. Called from Tick.
+	void StepTimeSlicedSearches(double BudgetMicroseconds, int32 MaxExpansions);
+
+	// Steps covered by the space-time reservation table in cooperative planning
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|Cooperative", meta=(ClampMin="1"))
+	int32 CooperativeWindow = 16;
+
+	// Parallel planning rounds before remaining conflicts are resolved one unit at a time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="AStar|Cooperative", meta=(ClampMin="0"))
+	int32 CooperativeMaxRounds = 4;
+
+	// Plans paths for a group of units heading to the same goal so they don't all claim the
+	// same cells at the same time (windowed cooperative A*). Returns one entry per start, in order.
+	// Only the first CooperativeWindow steps are coordinated, so replan every half window or so.
+	UFUNCTION(BlueprintCallable, Category="AStar|Cooperative")
+	TArray<FCooperativePath> FindGroupPathsCooperative(const TArray<FVector>& StartWorlds, const FVector& GoalWorld);
 	
 protected:
 	// Called when the game starts or when spawned
@@ -42,122 +225,28 @@ private:
 	FIntPoint WorldToCell(const FVector& WorldLocation) const;
 	FVector CellToWorld(const FIntPoint& Cell) const;
 
-    // Open set (binary heap with positions for decrease-key)
-    struct FHeapItem
-    {
-        int32 NodeIndex;
-        float F;
-    };
+	TArray<FVector> CellPathToWorld(const TArray<FIntPoint>& CellPath) const;
 
-    struct FBinaryHeapOpenSet
-    {
-        void Init(int32 NumNodes)
-        {
-            Heap.Empty();
-            Pos.Init(-1, NumNodes);
-        }
-
-        bool IsEmpty() const { return Heap.Num() == 0; }
-
-        void Clear()
-        {
-            for (const FHeapItem& It : Heap)
-            {
-                if (It.NodeIndex >= 0 && It.NodeIndex < Pos.Num())
-                    Pos[It.NodeIndex] = -1;
-            }
-            Heap.Empty();
-        }
-
-        void Push(int32 NodeIndex, float FVal)
-        {
-            FHeapItem Item{ NodeIndex, FVal };
-            Heap.Add(Item);
-            int32 i = Heap.Num() - 1;
-            Pos[NodeIndex] = i;
-            SiftUp(i);
-        }
-
-        int32 PopMin()
-        {
-            if (Heap.Num() == 0) return -1;
-            int32 Best = Heap[0].NodeIndex;
-            SwapNodes(0, Heap.Num() - 1);
-            Pos[Best] = -1;
-            Heap.Pop();
-            if (Heap.Num() > 0) SiftDown(0);
-            return Best;
-        }
-
-        void PushOrDecrease(int32 NodeIndex, float NewF)
-        {
-            if (NodeIndex < 0 || NodeIndex >= Pos.Num()) return;
-            int32 p = Pos[NodeIndex];
-            if (p == -1)
-            {
-                Push(NodeIndex, NewF);
-            }
-            else
-            {
-                if (NewF < Heap[p].F)
-                {
-                    Heap[p].F = NewF;
-                    SiftUp(p);
-                }
-            }
-        }
-
-        void ReservePos(int32 Num) { Pos.Init(-1, Num); }
-
-    private:
-        TArray<FHeapItem> Heap;
-        TArray<int32> Pos;
-
-        void SwapNodes(int32 A, int32 B)
-        {
-            if (A == B) return;
-            Exchange(Heap[A], Heap[B]);
-            Pos[Heap[A].NodeIndex] = A;
-            Pos[Heap[B].NodeIndex] = B;
-        }
-
-        void SiftUp(int32 i)
-        {
-            while (i > 0)
-            {
-                int32 Parent = (i - 1) >> 1;
-                if (Heap[i].F < Heap[Parent].F)
-                {
-                    SwapNodes(i, Parent);
-                    i = Parent;
-                }
-                else break;
-            }
-        }
-
-        void SiftDown(int32 i)
-        {
-            const int32 N = Heap.Num();
-            while (true)
-            {
-                int32 Left = i * 2 + 1;
-                int32 Right = Left + 1;
-                int32 Smallest = i;
-                if (Left < N && Heap[Left].F < Heap[Smallest].F) Smallest = Left;
-                if (Right < N && Heap[Right].F < Heap[Smallest].F) Smallest = Right;
-                if (Smallest != i) { SwapNodes(i, Smallest); i = Smallest; }
-                else break;
-            }
-        }
-    };
-
-    // Node arrays used in the search (simple POD arrays)
-    struct FSearchNode
-    {
-        float G = TNumericLimits<float>::Max(); // cost from stat
-        float H = 0.f; // heuristic
-        float F = TNumericLimits<float>::Max(); // final cost
-        int32 Parent = -1;
-        bool bClosed = false;
-    };
+	// World-space path with PathPostProcess applied
+	TArray<FVector> FinishPath(const TArray<FIntPoint>& CellPath, float UnitRadius = 0.f);
+
+	void RecordSearchStats(EAStarSearchMode Mode, const FAStarSearch& Search, double Milliseconds);
+	void RecordSearchStats(EAStarSearchMode Mode, bool bFound, int32 NodesExpanded, float PathCost, double Milliseconds);
+
+	UPROPERTY(VisibleAnywhere, Category="AStar|Stats")
+	TMap<EAStarSearchMode, FAStarModeStats> SearchStats;
+
+	FPathCache PathCache;
+
+	struct FTimeSlicedRequest
+	{
+		TUniquePtr<FAStarSearch> Search;
+		EAStarSearchMode Mode = EAStarSearchMode::Optimal;
+		double Milliseconds = 0.0;
+	};
+
+	// Pending and finished time-sliced searches, stepped in request order
+	TMap<int32, FTimeSlicedRequest> TimeSlicedSearches;
+	TArray<int32> TimeSlicedQueue;
+	int32 NextRequestId = 0;
 };
@@ -0,0 +1,521 @@
+#include "AStarSearch.h"
+#include "GridManager.h"
+#include "MassiveStats.h"
+#include "Misc/ScopeExit.h"
+#include "Algo/Reverse.h"
+
+bool FAStarSearch::Init(const AGridManager* InGridManager, const FIntPoint& InStartCell, const FIntPoint& InGoalCell, float InDiagonalCost,
+	const FAStarSearchParams& InParams)
+{
+	return InitMultiGoal(InGridManager, InStartCell, { InGoalCell }, InDiagonalCost, InParams);
+}
+
+bool FAStarSearch::InitMultiGoal(const AGridManager* InGridManager, const FIntPoint& InStartCell, const TArray<FIntPoint>& GoalCells,
+	float InDiagonalCost, const FAStarSearchParams& InParams)
+{
+	Reset();
+
+	GridManager = InGridManager;
+	StartCell = InStartCell;
+	DiagonalCost = InDiagonalCost;
+	Params = InParams;
+	Params.HeuristicWeight = FMath::Max(1.f, Params.HeuristicWeight);
+	Params.FocalEpsilon = FMath::Max(0.f, Params.FocalEpsilon);
+
+	if (!GridManager)
+	{
+		Status = EAStarSearchStatus::Failed;
+		return false;
+	}
+
+	// Validate start in-bounds and walkable (-1 means blocked)
+	if (!GridManager->IsInside(StartCell.X, StartCell.Y))
+	{
+		Status = EAStarSearchStatus::Failed;
+		return false;
+	}
+
+	GridWidth = GridManager->GridWidth;
+	NumNodes = GridManager->GridWidth * GridManager->GridHeight;
+	StartIdx = GridManager->XYToIndex(StartCell.X, StartCell.Y);
+
+	if (!GridManager->Grid.IsValidIndex(StartIdx) || GridManager->Grid[StartIdx].Cost < 0)
+	{
+		Status = EAStarSearchStatus::Failed;
+		return false;
+	}
+
+	// Keep only usable goals
+	for (const FIntPoint& Goal : GoalCells)
+	{
+		if (!GridManager->IsInside(Goal.X, Goal.Y)) continue;
+
+		const int32 Idx = GridManager->XYToIndex(Goal.X, Goal.Y);
+		if (!GridManager->Grid.IsValidIndex(Idx) || GridManager->Grid[Idx].Cost < 0) continue;
+
+		bool bAlreadyInSet = false;
+		GoalSet.Add(Idx, &bAlreadyInSet);
+		if (!bAlreadyInSet) GoalIndices.Add(Idx);
+	}
+
+	if (GoalIndices.Num() == 0)
+	{
+		Status = EAStarSearchStatus::Failed;
+		return false;
+	}
+
+	// Landmarks built with a larger diagonal cost would overestimate
+	if (Params.bUseLandmarks)
+	{
+		Landmarks = GridManager->GetLandmarks();
+		if (Landmarks.IsValid() && Landmarks->GetDiagonalCost() <= DiagonalCost)
+		{
+			LandmarkGoals.Reserve(GoalIndices.Num());
+			for (const int32 Goal : GoalIndices)
+			{
+				LandmarkGoals.Add(Landmarks->MakeGoal(Goal));
+			}
+		}
+		else
+		{
+			Landmarks.Reset();
+		}
+	}
+
+	// Reused searches only allocate when they grow, which is what the stat tracks
+	const int64 BytesBefore = GetAllocatedSize();
+	LLM_SCOPE_BYTAG(Massive_Search);
+
+	// Search buffers (default-constructed nodes are already "unvisited")
+	SearchNodes.SetNum(NumNodes);
+
+	switch (Params.OpenList)
+	{
+	case EPathOpenListType::BinaryHeap: BinaryOpenSet.Init(NumNodes); break;
+	case EPathOpenListType::BucketQueue: BucketOpenSet.Init(NumNodes, Params.BucketWidth); break;
+	default: QuaternaryOpenSet.Init(NumNodes); break;
+	}
+	if (IsFocal())
+	{
+		FocalSet.Init(NumNodes);
+		WaitingSet.Init(NumNodes);
+	}
+
+	MASSIVE_COUNTER_ADD(STAT_Massive_SearchBytes, FMath::Max<int64>(0, int64(GetAllocatedSize()) - BytesBefore));
+	Memory.Set(GetAllocatedSize());
+
+	// Initialize start
+	const float StartH = Heuristic(StartIdx);
+	SearchNodes[StartIdx].G = 0.f;
+	WithOpenSet([&](auto& OpenSet) { OpenSet.Push(StartIdx, Params.HeuristicWeight * StartH); }); // G=0 so F=W*H
+	if (IsFocal())
+	{
+		WaitingSet.Push(StartIdx, Params.HeuristicWeight * StartH);
+	}
+
+	BestIdx = StartIdx;
+	BestH = StartH;
+	Status = EAStarSearchStatus::InProgress;
+	return true;
+}
+
+void FAStarSearch::Reset()
+{
+	GridManager = nullptr;
+	GridWidth = 0;
+	NumNodes = 0;
+	StartIdx = -1;
+	GoalIndices.Reset();
+	GoalSet.Reset();
+	FoundGoalIdx = -1;
+	BestIdx = -1;
+	BestH = TNumericLimits<float>::Max();
+	NodesExpanded = 0;
+	Status = EAStarSearchStatus::NotStarted;
+	Params = FAStarSearchParams();
+	Landmarks.Reset();
+	LandmarkGoals.Reset();
+	SearchNodes.Reset();
+	BinaryOpenSet.Init(0);
+	QuaternaryOpenSet.Init(0);
+	BucketOpenSet.Init(0);
+	FocalSet.Init(0);
+	WaitingSet.Init(0);
+	FocalBound = -1.f;
+	Memory.Set(GetAllocatedSize());
+}
+
+SIZE_T FAStarSearch::GetAllocatedSize() const
+{
+	return SearchNodes.GetAllocatedSize() + BinaryOpenSet.GetAllocatedSize() + QuaternaryOpenSet.GetAllocatedSize() +
+		BucketOpenSet.GetAllocatedSize() + FocalSet.GetAllocatedSize() + WaitingSet.GetAllocatedSize();
+}
+
+FIntPoint FAStarSearch::GetGoalCell() const
+{
+	const int32 Idx = FoundGoalIdx != -1 ? FoundGoalIdx : (GoalIndices.Num() > 0 ? GoalIndices[0] : -1);
+	if (Idx == -1) return FIntPoint(-1, -1);
+
+	int32 X, Y;
+	IndexToXY(Idx, X, Y);
+	return FIntPoint(X, Y);
+}
+
+float FAStarSearch::MovementCostBetween(int32 AIndex, int32 BIndex) const
+{
+	int Ax, Ay, Bx, By;
+	IndexToXY(AIndex, Ax, Ay);
+	IndexToXY(BIndex, Bx, By);
+
+	int Dx = FMath::Abs(Ax - Bx);
+	int Dy = FMath::Abs(Ay - By);
+
+	if (Dx + Dy == 1) return 1.f;
+	return DiagonalCost;
+}
+
+// Octile heuristic (admissible/consistent for 8-way with DiagonalCost)
+float FAStarSearch::OctileDistance(int32 A, int32 B) const
+{
+	int32 Ax, Ay, Bx, By;
+	IndexToXY(A, Ax, Ay);
+	IndexToXY(B, Bx, By);
+	const int32 Dx = FMath::Abs(Ax - Bx);
+	const int32 Dy = FMath::Abs(Ay - By);
+	const float F  = float(FMath::Min(Dx, Dy));
+	return float(FMath::Max(Dx, Dy) - F) + DiagonalCost * F;
+}
+
+// Minimum over goals of max(octile, ALT). Min of admissible per-goal bounds stays admissible.
+float FAStarSearch::Heuristic(int32 A) const
+{
+	float Best = TNumericLimits<float>::Max();
+	for (int32 g = 0; g < GoalIndices.Num(); g++)
+	{
+		float H = OctileDistance(A, GoalIndices[g]);
+		if (Landmarks.IsValid())
+		{
+			H = FMath::Max(H, Landmarks->Heuristic(A, LandmarkGoals[g]));
+		}
+		Best = FMath::Min(Best, H);
+	}
+	return Best;
+}
+
+EAStarSearchStatus FAStarSearch::Step(int32 MaxExpansions, double MaxMicroseconds)
+{
+	if (Status != EAStarSearchStatus::InProgress) return Status;
+
+	// The grid was regenerated under us, the buffers no longer line up
+	if (!GridManager || GridManager->Grid.Num() != NumNodes || GridManager->GridWidth != GridWidth)
+	{
+		Status = EAStarSearchStatus::Failed;
+		return Status;
+	}
+
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_AStar);
+
+	const int32 ExpandedBefore = NodesExpanded;
+	const int32 HeapOperationsBefore = HeapOperations;
+	const EAStarSearchStatus Result = WithOpenSet([&](auto& OpenSet) { return StepImpl(OpenSet, MaxExpansions, MaxMicroseconds); });
+
+	MASSIVE_COUNTER_ADD(STAT_Massive_NodesExpanded, NodesExpanded - ExpandedBefore);
+	MASSIVE_COUNTER_ADD(STAT_Massive_HeapOperations, HeapOperations - HeapOperationsBefore);
+	return Result;
+}
+
+template<typename OpenSetType>
+EAStarSearchStatus FAStarSearch::StepImpl(OpenSetType& OpenSet, int32 MaxExpansions, double MaxMicroseconds)
+{
+	const bool bUseTimeBudget = MaxMicroseconds > 0.0;
+	const double EndTime = bUseTimeBudget ? FPlatformTime::Seconds() + MaxMicroseconds * 1e-6 : 0.0;
+
+	// Reading the clock every expansion is measurable, so only check every few nodes
+	constexpr int32 TimeCheckInterval = 16;
+	int32 ExpandedThisStep = 0;
+
+	while (!OpenSet.IsEmpty())
+	{
+		if (MaxExpansions > 0 && ExpandedThisStep >= MaxExpansions) return Status;
+		if (bUseTimeBudget && ExpandedThisStep > 0 && ExpandedThisStep % TimeCheckInterval == 0 &&
+			FPlatformTime::Seconds() >= EndTime)
+		{
+			return Status;
+		}
+
+		float CurrH = 0.f;
+		int32 Curr;
+		if (IsFocal())
+		{
+			Curr = PopFocal(OpenSet, CurrH);
+		}
+		else
+		{
+			float Key;
+			Curr = OpenSet.PopMin(Key);
+			if (Curr != -1) CurrH = HFromKey(Curr, Key);
+		}
+		if (Curr == -1) break;
+		++HeapOperations;
+
+		if (GoalSet.Contains(Curr))
+		{
+			FoundGoalIdx = Curr;
+			BestIdx = Curr;
+			BestH = 0.f;
+			Status = EAStarSearchStatus::Found;
+			return Status;
+		}
+
+		// Mark closed
+		FSearchNode& CurrNode = SearchNodes[Curr];
+		CurrNode.SetClosed(true);
+		++NodesExpanded;
+		++ExpandedThisStep;
+
+		// Track the closest node to the goal for partial paths
+		if (CurrH < BestH || (CurrH == BestH && CurrNode.G < SearchNodes[BestIdx].G))
+		{
+			BestIdx = Curr;
+			BestH = CurrH;
+		}
+
+		int32 CurrX, CurrY;
+		IndexToXY(Curr, CurrX, CurrY);
+
+		// Expand neighbors
+		const TArray<const FGridCell*> Neighbors = GridManager->GetNeighbors(CurrX, CurrY);
+		for (const FGridCell* NbCell : Neighbors)
+		{
+			const int32 Nb = GridManager->XYToIndex(NbCell->X, NbCell->Y);
+			FSearchNode& NbNode = SearchNodes[Nb];
+
+			// Focal search and the bucket queue have to reopen nodes to keep their bounds (both pop
+			// nodes that aren't the open minimum); weighted A* keeps its bound without it
+			if (NbNode.IsClosed() && !IsFocal() && Params.OpenList != EPathOpenListType::BucketQueue) continue;
+
+			if (Params.MinClearance > 1 && GridManager->GetClearance(Nb) < Params.MinClearance && !GoalSet.Contains(Nb)) continue;
+
+			// Terrain cost (>=1 for walkable; -1 means blocked, but we filtered earlier)
+			float TerrainCost = FMath::Max(1, NbCell->Cost);
+			if (Params.OccupancyWeight > 0.f) TerrainCost += Params.OccupancyWeight * GridManager->GetOccupancy(Nb);
+			const float MoveCost    = MovementCostBetween(Curr, Nb);
+			const float TentativeG  = CurrNode.G + MoveCost * TerrainCost;
+
+			if (TentativeG < NbNode.G)
+			{
+				const float H = Heuristic(Nb);
+				const float F = TentativeG + Params.HeuristicWeight * H;
+
+				NbNode.SetParent(Curr);
+				NbNode.G = TentativeG;
+				NbNode.SetClosed(false);
+
+				OpenSet.PushOrDecrease(Nb, F);
+				++HeapOperations;
+
+				// Anything that lands inside the current bound is a focal candidate right away,
+				// the rest waits until the bound grows past it
+				if (IsFocal())
+				{
+					if (F <= FocalBound)
+					{
+						WaitingSet.Remove(Nb);
+						if (!FocalSet.Contains(Nb)) FocalSet.Push(Nb, H);
+					}
+					else
+					{
+						WaitingSet.PushOrDecrease(Nb, F);
+					}
+				}
+			}
+		}
+	}
+
+	Status = EAStarSearchStatus::Failed;
+	return Status;
+}
+
+template<typename OpenSetType>
+int32 FAStarSearch::PopFocal(OpenSetType& OpenSet, float& OutH)
+{
+	if (OpenSet.IsEmpty()) return -1;
+
+	// Grow the focal list whenever the lowest F in the open set moves up. Only the waiting
+	// nodes the new bound reaches move over, cheapest F first, so each node moves at most once
+	// per time it is opened.
+	const float NewBound = OpenSet.PeekMinF() * (1.f + Params.FocalEpsilon);
+	if (NewBound > FocalBound)
+	{
+		FocalBound = NewBound;
+		while (!WaitingSet.IsEmpty() && WaitingSet.PeekMinF() <= FocalBound)
+		{
+			float F;
+			const int32 Node = WaitingSet.PopMin(F);
+			FocalSet.Push(Node, HFromKey(Node, F));
+			++HeapOperations;
+		}
+	}
+
+	// Min-F node is always within the bound, so this only triggers on float noise
+	if (FocalSet.IsEmpty())
+	{
+		float Key;
+		const int32 Node = OpenSet.PopMin(Key);
+		if (Node != -1)
+		{
+			OutH = HFromKey(Node, Key);
+			WaitingSet.Remove(Node);
+		}
+		return Node;
+	}
+
+	const int32 Node = FocalSet.PopMin(OutH);
+	OpenSet.Remove(Node);
+	return Node;
+}
+
+bool FAStarSearch::GetPath(TArray<FIntPoint>& OutPath) const
+{
+	OutPath.Reset();
+	if (Status != EAStarSearchStatus::Found) return false;
+
+	TracePath(FoundGoalIdx, OutPath);
+	return OutPath.Num() > 0;
+}
+
+bool FAStarSearch::GetBestPartialPath(TArray<FIntPoint>& OutPath) const
+{
+	OutPath.Reset();
+	if (Status == EAStarSearchStatus::NotStarted || BestIdx == -1) return false;
+
+	TracePath(BestIdx, OutPath);
+	return OutPath.Num() > 0;
+}
+
+void FAStarSearch::TracePath(int32 EndIdx, TArray<FIntPoint>& OutPath) const
+{
+	// Reconstruct path (grid-space)
+	int32 Trace = EndIdx;
+	while (Trace != -1)
+	{
+		int32 X, Y;
+		IndexToXY(Trace, X, Y);
+		OutPath.Add(FIntPoint(X, Y));
+		Trace = SearchNodes[Trace].GetParent();
+	}
+	Algo::Reverse(OutPath);
+}
+
+bool FAStarSearch::RunBidirectional(const AGridManager* GridManager, const FIntPoint& StartCell, const FIntPoint& GoalCell, float DiagonalCost,
+	bool bUseLandmarks, TArray<FIntPoint>& OutPath, int32& OutNodesExpanded, float& OutPathCost)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_AStarBidirectional);
+
+	OutPath.Reset();
+	OutNodesExpanded = 0;
+	OutPathCost = -1.f;
+
+	int32 HeapOperations = 0;
+	ON_SCOPE_EXIT
+	{
+		MASSIVE_COUNTER_ADD(STAT_Massive_NodesExpanded, OutNodesExpanded);
+		MASSIVE_COUNTER_ADD(STAT_Massive_HeapOperations, HeapOperations);
+	};
+
+	// Forward and backward searches share the validation and heuristic code of a regular search.
+	// The stopping rule needs exact frontier minimums, so both sides use a heap.
+	FAStarSearchParams Params;
+	Params.bUseLandmarks = bUseLandmarks;
+	Params.OpenList = EPathOpenListType::QuaternaryHeap;
+
+	FAStarSearch Fwd;
+	FAStarSearch Bwd;
+	if (!Fwd.Init(GridManager, StartCell, GoalCell, DiagonalCost, Params)) return false;
+
+	// Landmarks bound d(n, goal); the backward search needs d(start, n), so it sticks to octile
+	Params.bUseLandmarks = false;
+	if (!Bwd.Init(GridManager, GoalCell, StartCell, DiagonalCost, Params)) return false;
+
+	const int32 StartIdx = Fwd.StartIdx;
+	const int32 GoalIdx = Bwd.StartIdx;
+
+	if (StartIdx == GoalIdx)
+	{
+		OutPath.Add(StartCell);
+		OutPathCost = 0.f;
+		return true;
+	}
+
+	// Best meeting point found so far
+	float Mu = TNumericLimits<float>::Max();
+	int32 Meet = -1;
+
+	auto ConsiderMeeting = [&](int32 Node)
+	{
+		const float Total = Fwd.SearchNodes[Node].G + Bwd.SearchNodes[Node].G;
+		if (Fwd.SearchNodes[Node].G < TNumericLimits<float>::Max() &&
+			Bwd.SearchNodes[Node].G < TNumericLimits<float>::Max() &&
+			Total < Mu)
+		{
+			Mu = Total;
+			Meet = Node;
+		}
+	};
+
+	while (!Fwd.QuaternaryOpenSet.IsEmpty() && !Bwd.QuaternaryOpenSet.IsEmpty())
+	{
+		// Every unexplored path costs at least the larger of the two frontier minimums
+		if (Mu <= FMath::Max(Fwd.QuaternaryOpenSet.PeekMinF(), Bwd.QuaternaryOpenSet.PeekMinF())) break;
+
+		// Expand the side with the smaller frontier to keep the two balanced
+		const bool bForward = Fwd.QuaternaryOpenSet.Num() <= Bwd.QuaternaryOpenSet.Num();
+		FAStarSearch& Side = bForward ? Fwd : Bwd;
+
+		const int32 Curr = Side.QuaternaryOpenSet.PopMin();
+		if (Curr == -1) break;
+		++HeapOperations;
+
+		Side.SearchNodes[Curr].SetClosed(true);
+		++OutNodesExpanded;
+
+		int32 CurrX, CurrY;
+		Side.IndexToXY(Curr, CurrX, CurrY);
+
+		const TArray<const FGridCell*> Neighbors = GridManager->GetNeighbors(CurrX, CurrY);
+		for (const FGridCell* NbCell : Neighbors)
+		{
+			const int32 Nb = GridManager->XYToIndex(NbCell->X, NbCell->Y);
+			if (Side.SearchNodes[Nb].IsClosed()) continue;
+
+			// Edges cost step length times the entered cell. Going backwards, Nb -> Curr enters Curr.
+			const FGridCell& Entered = bForward ? *NbCell : GridManager->Grid[Curr];
+			const float TerrainCost = FMath::Max(1, Entered.Cost);
+			const float TentativeG  = Side.SearchNodes[Curr].G + Side.MovementCostBetween(Curr, Nb) * TerrainCost;
+
+			if (TentativeG < Side.SearchNodes[Nb].G)
+			{
+				Side.SearchNodes[Nb].SetParent(Curr);
+				Side.SearchNodes[Nb].G = TentativeG;
+				Side.QuaternaryOpenSet.PushOrDecrease(Nb, TentativeG + Side.Heuristic(Nb));
+				++HeapOperations;
+
+				ConsiderMeeting(Nb);
+			}
+		}
+	}
+
+	if (Meet == -1) return false;
+
+	// Start -> meeting point from the forward tree, then meeting point -> goal from the backward tree
+	Fwd.TracePath(Meet, OutPath);
+	for (int32 Trace = Bwd.SearchNodes[Meet].GetParent(); Trace != -1; Trace = Bwd.SearchNodes[Trace].GetParent())
+	{
+		int32 X, Y;
+		Fwd.IndexToXY(Trace, X, Y);
+		OutPath.Add(FIntPoint(X, Y));
+	}
+
+	OutPathCost = Mu;
+	return true;
+}
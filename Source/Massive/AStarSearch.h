@@ -0,0 +1,172 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridLandmarks.h"
+#include "PathfindingTypes.h"
+#include "MassiveStats.h"
+
+class AGridManager;
+
+enum class EAStarSearchStatus : uint8
+{
+	NotStarted,
+	InProgress,
+	Found,
+	Failed
+};
+
+struct FAStarSearchParams
+{
+	// Inflation applied to the heuristic (weighted A*). 1 = plain optimal A*.
+	float HeuristicWeight = 1.f;
+
+	// Focal search: expand the node closest to the goal among all open nodes with
+	// F <= (1 + FocalEpsilon) * min F. 0 disables focal search.
+	float FocalEpsilon = 0.f;
+
+	// Tighten octile with the grid's ALT landmarks when they are available
+	bool bUseLandmarks = true;
+
+	EPathOpenListType OpenList = EPathOpenListType::QuaternaryHeap;
+
+	// Cells with less clearance than this are skipped (see AGridManager::GetClearance).
+	// Goals are exempt so large units can still be ordered next to a wall.
+	int32 MinClearance = 0;
+
+	// Extra terrain cost per unit standing on the entered cell (AGridManager occupancy layer).
+	// Costs only go up, so octile and landmark bounds stay admissible.
+	float OccupancyWeight = 0.f;
+
+	// Key range per bucket for the bucket queue. 1 is exact for integral costs and DiagonalCost;
+	// otherwise paths can cost up to one BucketWidth more than optimal (see FBucketOpenSet).
+	float BucketWidth = 1.f;
+};
+
+// Resumable A* search over an AGridManager grid.
+// Init() once, then call Step() with an expansion and/or time budget until it
+// stops returning InProgress. The search can be suspended between calls
+// (e.g. across frames) as long as the grid is not regenerated in between.
+class MASSIVE_API FAStarSearch
+{
+public:
+	bool Init(const AGridManager* InGridManager, const FIntPoint& StartCell, const FIntPoint& GoalCell, float InDiagonalCost,
+		const FAStarSearchParams& InParams = FAStarSearchParams());
+
+	// Searches once toward the nearest of several goal cells, using the minimum heuristic over all goals.
+	// Blocked or out-of-bounds goals are ignored; fails if none are usable.
+	bool InitMultiGoal(const AGridManager* InGridManager, const FIntPoint& StartCell, const TArray<FIntPoint>& GoalCells, float InDiagonalCost,
+		const FAStarSearchParams& InParams = FAStarSearchParams());
+
+	// Optimal bidirectional A* for long single-goal queries, run to completion. Terrain costs
+	// only: no clearance filter or occupancy term. Returns false if no path exists.
+	static bool RunBidirectional(const AGridManager* GridManager, const FIntPoint& StartCell, const FIntPoint& GoalCell, float DiagonalCost,
+		bool bUseLandmarks, TArray<FIntPoint>& OutPath, int32& OutNodesExpanded, float& OutPathCost);
+
+	// Expands nodes until the goal is found, the open set runs dry or a budget is hit.
+	// A budget <= 0 means "no limit" for that budget; both <= 0 runs to completion.
+	EAStarSearchStatus Step(int32 MaxExpansions = 0, double MaxMicroseconds = 0.0);
+
+	// Full start -> goal path, only valid once the search is Found
+	bool GetPath(TArray<FIntPoint>& OutPath) const;
+
+	// Path from start to the expanded node closest to the goal (by heuristic).
+	// Returns the full path once Found, so callers can use it at any point.
+	bool GetBestPartialPath(TArray<FIntPoint>& OutPath) const;
+
+	void Reset();
+
+	EAStarSearchStatus GetStatus() const { return Status; }
+	bool IsDone() const { return Status == EAStarSearchStatus::Found || Status == EAStarSearchStatus::Failed; }
+	int32 GetNodesExpanded() const { return NodesExpanded; }
+	float GetPathCost() const { return Status == EAStarSearchStatus::Found ? SearchNodes[FoundGoalIdx].G : -1.f; }
+	const FAStarSearchParams& GetParams() const { return Params; }
+	FIntPoint GetStartCell() const { return StartCell; }
+
+	// Search nodes and open lists, kept between searches until Reset()
+	SIZE_T GetAllocatedSize() const;
+
+	// The goal that was reached (the first goal while the search is still running)
+	FIntPoint GetGoalCell() const;
+
+private:
+	FORCEINLINE void IndexToXY(int32 Index, int32& OutX, int32& OutY) const
+	{
+		OutY = Index / GridWidth; OutX = Index % GridWidth;
+	}
+
+	float MovementCostBetween(int32 AIndex, int32 BIndex) const;
+	float Heuristic(int32 A) const;
+	float OctileDistance(int32 A, int32 B) const;
+	void TracePath(int32 EndIdx, TArray<FIntPoint>& OutPath) const;
+
+	FORCEINLINE bool IsFocal() const { return Params.FocalEpsilon > 0.f; }
+
+	// Runs Func on whichever open list Params selects
+	template<typename FuncType>
+	decltype(auto) WithOpenSet(FuncType&& Func)
+	{
+		switch (Params.OpenList)
+		{
+		case EPathOpenListType::BinaryHeap: return Func(BinaryOpenSet);
+		case EPathOpenListType::BucketQueue: return Func(BucketOpenSet);
+		default: return Func(QuaternaryOpenSet);
+		}
+	}
+
+	template<typename OpenSetType>
+	EAStarSearchStatus StepImpl(OpenSetType& OpenSet, int32 MaxExpansions, double MaxMicroseconds);
+
+	template<typename OpenSetType>
+	int32 PopFocal(OpenSetType& OpenSet, float& OutH);
+
+	// Recovers H from an open list key, F = G + W * H
+	FORCEINLINE float HFromKey(int32 Node, float Key) const
+	{
+		return (Key - SearchNodes[Node].G) / Params.HeuristicWeight;
+	}
+
+	const AGridManager* GridManager = nullptr;
+	int32 GridWidth = 0;
+	int32 NumNodes = 0;
+	float DiagonalCost = 1.41421356237f;
+	FAStarSearchParams Params;
+
+	TSharedPtr<const FGridLandmarks> Landmarks;
+	TArray<FGridLandmarks::FGoal> LandmarkGoals;
+
+	FIntPoint StartCell = FIntPoint::ZeroValue;
+	int32 StartIdx = -1;
+
+	// All goal cells; a single-goal search is just the one-element case
+	TArray<int32> GoalIndices;
+	TSet<int32> GoalSet;
+	int32 FoundGoalIdx = -1;
+
+	// Closest expanded node to the goal, used for partial paths
+	int32 BestIdx = -1;
+	float BestH = TNumericLimits<float>::Max();
+
+	int32 NodesExpanded = 0;
+
+	// Open list pushes and pops, only read as a delta for stats
+	int32 HeapOperations = 0;
+
+	EAStarSearchStatus Status = EAStarSearchStatus::NotStarted;
+
+	TArray<FSearchNode> SearchNodes;
+
+	// Only the list selected by Params.OpenList is initialized, the others stay empty
+	FBinaryHeapOpenSet BinaryOpenSet;
+	FQuaternaryHeapOpenSet QuaternaryOpenSet;
+	FBucketOpenSet BucketOpenSet;
+
+	// Focal list keyed by H, subset of the open set within the current bound
+	FBinaryHeapOpenSet FocalSet;
+
+	// The rest of the open set, keyed by F, so a growing bound only touches the nodes it reaches
+	FBinaryHeapOpenSet WaitingSet;
+	float FocalBound = -1.f;
+
+	// Buffers above, reported under Search in Massive.Memory
+	FMassiveMemoryCounter Memory{EMassiveMemory::Search};
+};
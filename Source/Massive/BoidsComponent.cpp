@@ -1,5 +1,6 @@
 #include "BoidsComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "MassiveStats.h"
 
 UBoidsComponent::UBoidsComponent()
 {
@@ -35,45 +36,69 @@ FVector UBoidsComponent::ComputeBoidsOffset()
 	const FIntPoint MyCell = GridManager->WorldToCell(MyPos);
 
 	// Collect nearby actors
-	TArray<AActor*> Neighbors;
+	TArray<AActor*>& Neighbors = NeighborScratch;
+	Neighbors.Reset();
+	{
+		MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_BoidsGather);
+		LLM_SCOPE_BYTAG(Massive_Boids);
 
-	// Scan nearby grid cells
-	const int CellRadius = FMath::CeilToInt(NeighborRadius / GridManager->CellSize);
+		// Scan nearby grid cells
+		const int CellRadius = FMath::CeilToInt(NeighborRadius / GridManager->CellSize);
 
-	// Now find actors near this cell
-	TArray<AActor*> Temp;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), Owner->GetClass(), Temp);
+		// Now find actors near this cell
+		TArray<AActor*>& Temp = ActorScratch;
+		UGameplayStatics::GetAllActorsOfClass(GetWorld(), Owner->GetClass(), Temp);
 	
-	for (int y = -CellRadius; y <= CellRadius; ++y)
-	{
-		for (int x = -CellRadius; x <= CellRadius; ++x)
+		for (int y = -CellRadius; y <= CellRadius; ++y)
 		{
-			const int NX = MyCell.X + x;
-			const int NY = MyCell.Y + y;
+			for (int x = -CellRadius; x <= CellRadius; ++x)
+			{
+				const int NX = MyCell.X + x;
+				const int NY = MyCell.Y + y;
 
-			if (!GridManager->IsInside(NX, NY)) continue;
+				if (!GridManager->IsInside(NX, NY)) continue;
 
-			const FVector CellWorld = GridManager->CellToWorld(FIntPoint(NX, NY));
+				const FVector CellWorld = GridManager->CellToWorld(FIntPoint(NX, NY));
 
-			// Distance check
-			if (FVector::DistSquared(CellWorld, MyPos) > NeighborRadius * NeighborRadius) continue;
+				// Distance check
+				if (FVector::DistSquared(CellWorld, MyPos) > NeighborRadius * NeighborRadius) continue;
 
-			for (AActor* Other : Temp)
-			{
-				//UE_LOG(LogTemp, Warning, TEXT("The Actor's name is: %s"), *Other->GetName());
+				for (AActor* Other : Temp)
+				{
+					//UE_LOG(LogTemp, Warning, TEXT("The Actor's name is: %s"), *Other->GetName());
 				
-				if (!Other || Other == Owner) continue;
+					if (!Other || Other == Owner) continue;
 
-				const float D = FVector::Dist(MyPos, Other->GetActorLocation());
-				if (D <= NeighborRadius)
-				{
-					Neighbors.Add(Other);
+					const float D = FVector::Dist(MyPos, Other->GetActorLocation());
+					if (D <= NeighborRadius)
+					{
+						Neighbors.Add(Other);
+					}
 				}
 			}
 		}
+
+		// Actor iteration order isn't stable between runs and float sums depend on it.
+		// Position first, so the order doesn't hinge on names that change with spawn counts.
+		if (GridManager->bDeterministic)
+		{
+			Neighbors.Sort([](const AActor& A, const AActor& B)
+			{
+				const FVector LocA = A.GetActorLocation();
+				const FVector LocB = B.GetActorLocation();
+				if (LocA.X != LocB.X) return LocA.X < LocB.X;
+				if (LocA.Y != LocB.Y) return LocA.Y < LocB.Y;
+				if (LocA.Z != LocB.Z) return LocA.Z < LocB.Z;
+				return A.GetFName().LexicalLess(B.GetFName());
+			});
+		}
+
+		BoidsMemory.Set(NeighborScratch.GetAllocatedSize() + ActorScratch.GetAllocatedSize());
 	}
 
 	if (Neighbors.Num() == 0) return FVector::ZeroVector;
+
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_BoidsSteer);
 	
 	FVector Separation = FVector::ZeroVector;
 	FVector Alignment = FVector::ZeroVector;
@@ -45,4 +45,10 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	FVector ComputeBoidsOffset();
+
+private:
+	// Reused by ComputeBoidsOffset so each call doesn't reallocate; only valid during the call
+	TArray<AActor*> ActorScratch;
+	TArray<AActor*> NeighborScratch;
+	FMassiveMemoryCounter BoidsMemory{EMassiveMemory::Boids};
 };
@@ -0,0 +1,304 @@
+#include "CooperativePathfinder.h"
+#include "MassiveStats.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+void FCooperativePathfinder::PlanGroup(const FGridCostField& Field, const TArray<FIntPoint>& Starts, const FIntPoint& Goal,
+	const FCooperativePathParams& Params, TArray<FCooperativeAgentPath>& OutPaths, FCooperativePlanStats* OutStats)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_Cooperative);
+	LLM_SCOPE_BYTAG(Massive_Search);
+
+	FCooperativePlanStats Stats;
+	OutPaths.Reset();
+	OutPaths.SetNum(Starts.Num());
+
+	if (!Field.IsInside(Goal.X, Goal.Y) || !Field.IsWalkable(Field.XYToIndex(Goal.X, Goal.Y)))
+	{
+		if (OutStats) *OutStats = Stats;
+		return;
+	}
+
+	const int32 GoalCell = Field.XYToIndex(Goal.X, Goal.Y);
+	const int32 Window = FMath::Max(1, Params.Window);
+
+	// Exact cost-to-goal for every cell: the heuristic for all agents, and the path past the window
+	TArray<float> GoalDist;
+	Field.ComputeDistances(GoalCell, Params.DiagonalCost, true, GoalDist);
+
+	FMassiveMemoryCounter SearchMemory(EMassiveMemory::Search);
+	SearchMemory.Set(GoalDist.GetAllocatedSize());
+
+	// Agents closest to the goal go first so the front of the group clears the way for the rest
+	TArray<int32> Pending;
+	TArray<int32> StartCells;
+	StartCells.Init(INDEX_NONE, Starts.Num());
+	for (int32 Agent = 0; Agent < Starts.Num(); Agent++)
+	{
+		const FIntPoint& Start = Starts[Agent];
+		if (!Field.IsInside(Start.X, Start.Y)) continue;
+
+		const int32 Cell = Field.XYToIndex(Start.X, Start.Y);
+		if (!Field.IsWalkable(Cell) || GoalDist[Cell] >= TNumericLimits<float>::Max()) continue;
+
+		StartCells[Agent] = Cell;
+		Pending.Add(Agent);
+	}
+	Pending.Sort([&](int32 A, int32 B) { return GoalDist[StartCells[A]] < GoalDist[StartCells[B]]; });
+
+	TArray<TArray<int32>> TimedPaths;
+	TimedPaths.SetNum(Starts.Num());
+
+	FReservationTable Table;
+
+	for (int32 Round = 0; Round < Params.MaxRounds && Pending.Num() > 0; Round++)
+	{
+		// Every search reads the same table snapshot, nothing writes to it until the commit pass
+		TArray<bool> Planned;
+		TArray<int64> Expanded;
+		Planned.SetNumZeroed(Pending.Num());
+		Expanded.SetNumZeroed(Pending.Num());
+
+		ParallelFor(Pending.Num(), [&](int32 i)
+		{
+			const int32 Agent = Pending[i];
+			Planned[i] = PlanAgent(Field, GoalDist, Agent, StartCells[Agent], GoalCell, Table, Params, TimedPaths[Agent], Expanded[i]);
+		});
+
+		// Commit in priority order. The first agent always goes through since nothing changed
+		// before it, so every round makes progress.
+		TArray<int32> Retry;
+		for (int32 i = 0; i < Pending.Num(); i++)
+		{
+			const int32 Agent = Pending[i];
+			Stats.NodesExpanded += Expanded[i];
+
+			if (!Planned[i] || HasConflict(TimedPaths[Agent], Agent, GoalCell, Table, Window))
+			{
+				Stats.Conflicts += Planned[i] ? 1 : 0;
+				Retry.Add(Agent);
+				continue;
+			}
+
+			Commit(TimedPaths[Agent], Agent, GoalCell, Table, Window);
+		}
+
+		Pending = MoveTemp(Retry);
+		Stats.Rounds++;
+	}
+
+	// Whatever is left is planned against the live table one at a time
+	for (const int32 Agent : Pending)
+	{
+		Stats.SequentialAgents++;
+
+		int64 Expanded = 0;
+		if (!PlanAgent(Field, GoalDist, Agent, StartCells[Agent], GoalCell, Table, Params, TimedPaths[Agent], Expanded))
+		{
+			// Boxed in for the whole window: fall back to the plain shortest path and let local avoidance sort it out
+			TimedPaths[Agent] = { StartCells[Agent] };
+			AppendDescent(Field, GoalDist, GoalCell, Params.DiagonalCost, TimedPaths[Agent]);
+		}
+		Stats.NodesExpanded += Expanded;
+
+		Commit(TimedPaths[Agent], Agent, GoalCell, Table, Window);
+	}
+
+	// Collapse waits into step gaps
+	for (int32 Agent = 0; Agent < Starts.Num(); Agent++)
+	{
+		const TArray<int32>& Timed = TimedPaths[Agent];
+		if (StartCells[Agent] == INDEX_NONE || Timed.Num() == 0) continue;
+
+		FCooperativeAgentPath& Out = OutPaths[Agent];
+		for (int32 Step = 0; Step < Timed.Num(); Step++)
+		{
+			if (Step > 0 && Timed[Step] == Timed[Step - 1]) continue;
+			Out.Cells.Add(FIntPoint(Timed[Step] % Field.Width, Timed[Step] / Field.Width));
+			Out.Steps.Add(Step);
+		}
+		Out.bFound = Timed.Last() == GoalCell;
+	}
+
+	if (OutStats) *OutStats = Stats;
+}
+
+bool FCooperativePathfinder::PlanAgent(const FGridCostField& Field, const TArray<float>& GoalDist, int32 Agent, int32 StartCell, int32 GoalCell,
+	const FReservationTable& Table, const FCooperativePathParams& Params, TArray<int32>& OutTimedCells, int64& OutNodesExpanded)
+{
+	struct FStateNode
+	{
+		int32 Cell;
+		int32 Step;
+		int32 Parent;
+		float G;
+	};
+
+	struct FQueueItem
+	{
+		float F;
+		int32 Node;
+		bool operator<(const FQueueItem& Other) const { return F < Other.F; }
+	};
+
+	OutTimedCells.Reset();
+	OutNodesExpanded = 0;
+
+	const int32 Window = FMath::Max(1, Params.Window);
+	const int32 NumCells = Field.Num();
+
+	// Only the states actually touched are stored, a full (Window + 1) x cells table would be mostly empty
+	TArray<FStateNode> Nodes;
+	TMap<int64, int32> BestNode;
+	TArray<FQueueItem> Queue;
+
+	auto StateKey = [NumCells](int32 Cell, int32 Step) { return int64(Step) * NumCells + Cell; };
+
+	auto TryAdd = [&](int32 Cell, int32 Step, int32 Parent, float G)
+	{
+		if (GoalDist[Cell] >= TNumericLimits<float>::Max()) return;
+
+		int32& Best = BestNode.FindOrAdd(StateKey(Cell, Step), INDEX_NONE);
+		if (Best != INDEX_NONE && Nodes[Best].G <= G) return;
+
+		Best = Nodes.Add({ Cell, Step, Parent, G });
+		Queue.HeapPush({ G + GoalDist[Cell], Best });
+	};
+
+	// Arriving early only works if nobody else needs the goal for the rest of the window
+	auto CanHoldGoal = [&](int32 FromStep)
+	{
+		for (int32 Step = FromStep + 1; Step <= Window; Step++)
+		{
+			if (!Table.IsFree(GoalCell, Step, Agent)) return false;
+		}
+		return true;
+	};
+
+	TryAdd(StartCell, 0, INDEX_NONE, 0.f);
+
+	int32 Neighbors[8];
+	bool IsDiagonal[8];
+	int32 EndNode = INDEX_NONE;
+
+	while (Queue.Num() > 0)
+	{
+		FQueueItem Item;
+		Queue.HeapPop(Item, EAllowShrinking::No);
+
+		// Lazy deletion, a cheaper path to the same state was queued later
+		const FStateNode Node = Nodes[Item.Node];
+		if (BestNode.FindChecked(StateKey(Node.Cell, Node.Step)) != Item.Node) continue;
+
+		// Past the window reservations no longer apply, GoalDist finishes the path exactly
+		if ((Node.Cell == GoalCell && CanHoldGoal(Node.Step)) || Node.Step >= Window)
+		{
+			EndNode = Item.Node;
+			break;
+		}
+
+		if (++OutNodesExpanded > Params.MaxExpansionsPerAgent) break;
+
+		const int32 NextStep = Node.Step + 1;
+
+		// Wait in place
+		if (Table.IsFree(Node.Cell, NextStep, Agent))
+		{
+			TryAdd(Node.Cell, NextStep, Item.Node, Node.G + Params.WaitCost);
+		}
+
+		const int32 Count = Field.GetNeighbors(Node.Cell, Neighbors, IsDiagonal);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Nb = Neighbors[i];
+			if (!Table.IsFree(Nb, NextStep, Agent) || Table.IsSwap(Node.Cell, Nb, Node.Step, Agent)) continue;
+
+			const float StepCost = IsDiagonal[i] ? Params.DiagonalCost : 1.f;
+			TryAdd(Nb, NextStep, Item.Node, Node.G + StepCost * Field.Costs[Nb]);
+		}
+	}
+
+	if (EndNode == INDEX_NONE) return false;
+
+	for (int32 Trace = EndNode; Trace != INDEX_NONE; Trace = Nodes[Trace].Parent)
+	{
+		OutTimedCells.Add(Nodes[Trace].Cell);
+	}
+	Algo::Reverse(OutTimedCells);
+
+	AppendDescent(Field, GoalDist, GoalCell, Params.DiagonalCost, OutTimedCells);
+	return true;
+}
+
+void FCooperativePathfinder::AppendDescent(const FGridCostField& Field, const TArray<float>& GoalDist, int32 GoalCell, float DiagonalCost,
+	TArray<int32>& InOutTimedCells)
+{
+	if (InOutTimedCells.Num() == 0) return;
+
+	int32 Neighbors[8];
+	bool IsDiagonal[8];
+
+	// Each step strictly lowers GoalDist, the cap only guards against a corrupt field
+	int32 Cell = InOutTimedCells.Last();
+	for (int32 Guard = 0; Cell != GoalCell && Guard < Field.Num(); Guard++)
+	{
+		int32 BestNext = INDEX_NONE;
+		float BestCost = TNumericLimits<float>::Max();
+
+		const int32 Count = Field.GetNeighbors(Cell, Neighbors, IsDiagonal);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Nb = Neighbors[i];
+			if (GoalDist[Nb] >= TNumericLimits<float>::Max()) continue;
+
+			const float Cost = (IsDiagonal[i] ? DiagonalCost : 1.f) * Field.Costs[Nb] + GoalDist[Nb];
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestNext = Nb;
+			}
+		}
+
+		if (BestNext == INDEX_NONE) break;
+		Cell = BestNext;
+		InOutTimedCells.Add(Cell);
+	}
+}
+
+bool FCooperativePathfinder::HasConflict(const TArray<int32>& TimedCells, int32 Agent, int32 GoalCell, const FReservationTable& Table, int32 Window)
+{
+	// Step 0 is where the agents already are, several may share a start cell
+	const int32 LastStep = FMath::Min(TimedCells.Num() - 1, Window);
+	for (int32 Step = 1; Step <= LastStep; Step++)
+	{
+		if (!Table.IsFree(TimedCells[Step], Step, Agent)) return true;
+		if (Table.IsSwap(TimedCells[Step - 1], TimedCells[Step], Step - 1, Agent)) return true;
+	}
+
+	// Arrived inside the window, so it holds the goal until the window ends
+	if (TimedCells.Last() == GoalCell)
+	{
+		for (int32 Step = TimedCells.Num(); Step <= Window; Step++)
+		{
+			if (!Table.IsFree(GoalCell, Step, Agent)) return true;
+		}
+	}
+	return false;
+}
+
+void FCooperativePathfinder::Commit(const TArray<int32>& TimedCells, int32 Agent, int32 GoalCell, FReservationTable& Table, int32 Window)
+{
+	const int32 LastStep = FMath::Min(TimedCells.Num() - 1, Window);
+	for (int32 Step = 1; Step <= LastStep; Step++)
+	{
+		Table.Reserve(TimedCells[Step], Step, Agent);
+	}
+
+	if (TimedCells.Last() == GoalCell)
+	{
+		for (int32 Step = TimedCells.Num(); Step <= Window; Step++)
+		{
+			Table.Reserve(GoalCell, Step, Agent);
+		}
+	}
+}
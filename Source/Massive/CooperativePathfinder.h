@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCostField.h"
+
+struct FCooperativePathParams
+{
+	// Reservations only cover this many steps; past it agents follow their shortest path
+	// unconstrained, so callers should replan every Window / 2 steps or so
+	int32 Window = 16;
+
+	// Parallel planning rounds before the agents still in conflict are planned one by one
+	int32 MaxRounds = 4;
+
+	// Space-time expansions per agent before giving up on coordination for it
+	int32 MaxExpansionsPerAgent = 20000;
+
+	float DiagonalCost = 1.41421356237f;
+
+	// Cost of standing still for one step
+	float WaitCost = 1.f;
+};
+
+struct FCooperativeAgentPath
+{
+	// Cells the agent visits and the step it should be in each one.
+	// Waits are not repeated, they show up as gaps between consecutive Steps.
+	TArray<FIntPoint> Cells;
+	TArray<int32> Steps;
+	bool bFound = false;
+};
+
+struct FCooperativePlanStats
+{
+	int32 Rounds = 0;
+	int32 Conflicts = 0;
+	int32 SequentialAgents = 0;
+	int64 NodesExpanded = 0;
+};
+
+// Windowed hierarchical cooperative A* (WHCA*) for a group sharing one goal.
+// Agents plan in space-time (cell, step) around each other's reservations for the first
+// Window steps, using exact distances to the goal (one reverse Dijkstra) as the heuristic.
+// Each round plans all pending agents in parallel against a snapshot of the table, then
+// commits them in priority order; agents whose plan collides with an earlier commit are
+// replanned next round.
+class MASSIVE_API FCooperativePathfinder
+{
+public:
+	static void PlanGroup(const FGridCostField& Field, const TArray<FIntPoint>& Starts, const FIntPoint& Goal,
+		const FCooperativePathParams& Params, TArray<FCooperativeAgentPath>& OutPaths, FCooperativePlanStats* OutStats = nullptr);
+
+private:
+	// (step, cell) -> agent that holds the cell at that step
+	class FReservationTable
+	{
+	public:
+		FORCEINLINE int32 GetOwner(int32 Cell, int32 Step) const
+		{
+			const int32* Owner = Owners.Find(MakeKey(Cell, Step));
+			return Owner ? *Owner : INDEX_NONE;
+		}
+
+		FORCEINLINE bool IsFree(int32 Cell, int32 Step, int32 Agent) const
+		{
+			const int32 Owner = GetOwner(Cell, Step);
+			return Owner == INDEX_NONE || Owner == Agent;
+		}
+
+		// Moving From -> To between Step and Step + 1 would swap places with another agent
+		bool IsSwap(int32 From, int32 To, int32 Step, int32 Agent) const
+		{
+			const int32 Other = GetOwner(To, Step);
+			return Other != INDEX_NONE && Other != Agent && GetOwner(From, Step + 1) == Other;
+		}
+
+		// First reservation wins, a later fallback path never evicts an agent that planned around the table
+		void Reserve(int32 Cell, int32 Step, int32 Agent) { Owners.FindOrAdd(MakeKey(Cell, Step), Agent); }
+
+	private:
+		static FORCEINLINE uint64 MakeKey(int32 Cell, int32 Step) { return (uint64(uint32(Step)) << 32) | uint32(Cell); }
+
+		TMap<uint64, int32> Owners;
+	};
+
+	// Space-time A* for one agent. OutTimedCells holds one cell per step, waits included.
+	static bool PlanAgent(const FGridCostField& Field, const TArray<float>& GoalDist, int32 Agent, int32 StartCell, int32 GoalCell,
+		const FReservationTable& Table, const FCooperativePathParams& Params, TArray<int32>& OutTimedCells, int64& OutNodesExpanded);
+
+	// Appends the shortest path from the last cell to the goal by walking down GoalDist
+	static void AppendDescent(const FGridCostField& Field, const TArray<float>& GoalDist, int32 GoalCell, float DiagonalCost,
+		TArray<int32>& InOutTimedCells);
+
+	static bool HasConflict(const TArray<int32>& TimedCells, int32 Agent, int32 GoalCell, const FReservationTable& Table, int32 Window);
+	static void Commit(const TArray<int32>& TimedCells, int32 Agent, int32 GoalCell, FReservationTable& Table, int32 Window);
+};
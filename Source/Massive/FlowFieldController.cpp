@@ -3,10 +3,12 @@
 #include "GridManager.h"
 #include "PropertyAccess.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
 
 AFlowFieldController::AFlowFieldController()
 {
-	PrimaryActorTick.bCanEverTick = false;
+	// Only does work in continuum crowd mode
+	PrimaryActorTick.bCanEverTick = true;
 }
 
 void AFlowFieldController::BeginPlay()
@@ -60,103 +62,279 @@ FIntPoint AFlowFieldController::WorldLocationToIndex(FVector const& WorldLocatio
 	return FIntPoint(GridX, GridY);
 }
 
+FVector AFlowFieldController::GetFlowDirection(const FIntPoint& Cell) const
+{
+	if (!GridManager || !GridManager->IsInside(Cell.X, Cell.Y) || Solution.Num() != GridManager->Grid.Num()) return FVector::ZeroVector;
+
+	return Solution.GetDirection(GridManager->XYToIndex(Cell.X, Cell.Y));
+}
+
+float AFlowFieldController::GetIntegration(const FIntPoint& Cell) const
+{
+	if (!GridManager || !GridManager->IsInside(Cell.X, Cell.Y) || Solution.Num() != GridManager->Grid.Num()) return TNumericLimits<float>::Max();
+
+	return Solution.Integration[GridManager->XYToIndex(Cell.X, Cell.Y)];
+}
+
 FVector AFlowFieldController::GetFlowOfCell(const FIntPoint& index, const TArray<FGridCell>& OverrideGrid)
 {
-	int32 const FlattenedIndex = index.Y * GridManager->GridWidth + index.X;
+	if (!GridManager || !GridManager->IsInside(index.X, index.Y)) return FVector::ZeroVector;
 
-	if (FlattenedIndex < 0 && FlattenedIndex >= GridManager->Grid.Num())
-	{
-		return FVector::ZeroVector;
-	}
-	
-	return OverrideGrid[FlattenedIndex].FlowDirection;
+	if (Solution.Num() == GridManager->Grid.Num()) return GetFlowDirection(index);
+
+	int32 const FlattenedIndex = GridManager->XYToIndex(index.X, index.Y);
+	return OverrideGrid.IsValidIndex(FlattenedIndex) ? OverrideGrid[FlattenedIndex].FlowDirection : FVector::ZeroVector;
 }
 
 void AFlowFieldController::SetTargetCell(int32 const& x, int32 const& y)
 {
 	TargetIndex = FIntPoint(x, y);
 
-	for (FGridCell& Cell : GridManager->Grid)
+	if (GridManager->IsInside(x, y) && TryRetarget(GridManager->XYToIndex(x, y))) return;
+
+	TargetCells.Reset();
+	TargetCosts.Reset();
+	if (GridManager->IsInside(x, y))
 	{
-		Cell.IntegrationValue = TNumericLimits<int32>::Max();
+		TargetCells.Add(GridManager->XYToIndex(x, y));
 	}
 
-	ComputeIntegrationField();
-	ComputeDirections();
+	RebuildField();
 }
 
-void AFlowFieldController::ComputeIntegrationField()
+bool AFlowFieldController::TryRetarget(int32 NewTargetCell)
 {
-	if (!GridManager) return;
+	if (!bIncrementalRetarget || Method != EFlowFieldMethod::Wavefront || bContinuumCrowd) return false;
+	if (LastGridVersion != GridManager->GetGridVersion() || TargetCells.Num() != 1 || TargetCosts.Num() != 0) return false;
 
-	// Reset all integration values
-	for (FGridCell& Cell : GridManager->Grid) { Cell.IntegrationValue = FLT_MAX; }
-	
-	FIntPoint TargetCellIndex = TargetIndex; // Assuming TargetIndex is valid
-	int32 TargetIdx = GridManager->XYToIndex(TargetCellIndex.X, TargetCellIndex.Y);
-	if (!GridManager->IsInside(TargetCellIndex.X, TargetCellIndex.Y)) return;
+	const int32 Width = GridManager->GridWidth;
+	const int32 OldTargetCell = TargetCells[0];
+	const int32 Moved = FMath::Max(FMath::Abs(NewTargetCell % Width - OldTargetCell % Width), FMath::Abs(NewTargetCell / Width - OldTargetCell / Width));
+	if (Moved > MaxRetargetDistance) return false;
 
-	FGridCell* TargetCell = &GridManager->Grid[TargetIdx];
-	TargetCell->IntegrationValue = 0.f;
-	
-	TQueue<FGridCell*> CellQueue;
-	CellQueue.Enqueue(TargetCell);
+	// Settings changed since the last build (AnglePenalty, UnitRadius, occupancy) are only
+	// picked up by the next full rebuild
+	float Drift = 0.f;
+	if (!FFlowFieldSolver::Reroot(LastProblem, Solution, NewTargetCell, Scratch, Drift, RetargetDirtyCells)) return false;
+
+	RetargetDrift += Drift;
+	if (RetargetDrift > MaxRetargetDrift) return false;
+
+	TargetCells[0] = NewTargetCell;
+	TargetVersion++;
+	if (bWriteFieldToGrid) ApplySolutionCells(Solution, RetargetDirtyCells);
+	UpdateMemoryStats();
+	return true;
+}
+
+TArray<FGridCell> const& AFlowFieldController::SetTargetCells(const TArray<FIntPoint>& Cells, const TArray<float>& InitialCosts)
+{
+	if (GridManager->Grid.Num() == 0) return GridManager->Grid;
 
-	while (!CellQueue.IsEmpty())
+	TargetCells.Reset(Cells.Num());
+	TargetCosts.Reset(Cells.Num());
+	for (int32 i = 0; i < Cells.Num(); i++)
 	{
-		FGridCell* Current;
-		CellQueue.Dequeue(Current);
+		if (!GridManager->IsInside(Cells[i].X, Cells[i].Y)) continue;
 
-		for (const FGridCell* NeighborConst : GridManager->GetNeighbors(Current->X, Current->Y))
-		{
-			FGridCell* Neighbor = const_cast<FGridCell*>(NeighborConst); // safe, GridManager owns the data
-			
-			FVector2D const DirToTarget = FVector2D(TargetCell->WorldLocation - Neighbor->WorldLocation).GetSafeNormal();
-			float const Angle = FMath::Atan2(DirToTarget.Y, DirToTarget.X);
-			float const Snapped = FMath::RoundToFloat(Angle / (PI / 2.f)) * (PI / 2.f);
-
-			// If an angle is 15 degrees more than a cardinal direction we consider it 'diagonal' and add a cost to it
-			float NeighborCost = Neighbor->Cost;
-			if (FMath::Abs(Angle - Snapped) > (PI / 12.f)) NeighborCost += AnglePenalty;
-
-			float NewCost = Current->IntegrationValue + NeighborCost;
-			
-			if (NewCost < Neighbor->IntegrationValue)
-			{
-				Neighbor->IntegrationValue = NewCost;
-				CellQueue.Enqueue(Neighbor);
-			}
-		}
+		TargetCells.Add(GridManager->XYToIndex(Cells[i].X, Cells[i].Y));
+		TargetCosts.Add(InitialCosts.IsValidIndex(i) ? InitialCosts[i] : 0.f);
 	}
+
+	if (Cells.Num() > 0) TargetIndex = Cells[0];
+
+	RebuildField();
+	return GridManager->Grid;
 }
 
-void AFlowFieldController::ComputeDirections()
+TArray<FGridCell> const& AFlowFieldController::SetTargetLocations(const TArray<FVector>& WorldLocations, const TArray<float>& InitialCosts)
 {
-	for (FGridCell& Cell : GridManager->Grid)
+	if (GridManager->Grid.Num() == 0) return GridManager->Grid;
+
+	TArray<FIntPoint> Cells;
+	Cells.Reserve(WorldLocations.Num());
+	for (const FVector& Location : WorldLocations)
 	{
-		TArray<const FGridCell*> Neighbors = GridManager->GetNeighbors(Cell.X, Cell.Y);
+		Cells.Add(WorldLocationToIndex(Location));
+	}
 
-		const FGridCell* BestNeighbor = nullptr;
-		float BestCost = Cell.IntegrationValue;
+	return SetTargetCells(Cells, InitialCosts);
+}
 
-		for (const FGridCell* Neighbor : Neighbors)
-		{
-			if (Neighbor->IntegrationValue < BestCost)
-			{
-				BestNeighbor = Neighbor;
-				BestCost = Neighbor->IntegrationValue;
-			}
-		}
+TArray<FGridCell> const& AFlowFieldController::SetTargetArea(const FBox& WorldArea)
+{
+	if (GridManager->Grid.Num() == 0) return GridManager->Grid;
+
+	const FIntPoint Min = WorldLocationToIndex(WorldArea.Min);
+	const FIntPoint Max = WorldLocationToIndex(WorldArea.Max);
 
-		if (BestNeighbor)
+	TArray<FIntPoint> Cells;
+	for (int32 y = Min.Y; y <= Max.Y; y++)
+	{
+		for (int32 x = Min.X; x <= Max.X; x++)
 		{
-			FVector const Direction = (BestNeighbor->WorldLocation - Cell.WorldLocation).GetSafeNormal();
-			Cell.FlowDirection = Direction;
+			const int32 Index = GridManager->XYToIndex(x, y);
+			if (!GridManager->IsWalkable(Index)) continue;
+
+			// WorldLocationToIndex clamps to the grid, so edge cells still need their center checked
+			const FVector Center = GridManager->CellToWorld(FIntPoint(x, y));
+			if (Center.X < WorldArea.Min.X || Center.X > WorldArea.Max.X || Center.Y < WorldArea.Min.Y || Center.Y > WorldArea.Max.Y) continue;
+
+			Cells.Add(FIntPoint(x, y));
 		}
-		else
+	}
+
+	return SetTargetCells(Cells, TArray<float>());
+}
+
+void AFlowFieldController::RebuildField()
+{
+	TargetVersion++;
+
+	MakeProblem(LastProblem);
+	FFlowFieldSolver::Solve(LastProblem, Solution, Scratch);
+	FinishBatchBuild();
+}
+
+bool AFlowFieldController::BeginBatchBuild(const FVector& TargetLocation, const TSharedPtr<const FGridCostField>& SharedField)
+{
+	if (!GridManager || GridManager->Grid.Num() == 0) return false;
+
+	TargetIndex = WorldLocationToIndex(TargetLocation);
+	TargetCells = { GridManager->XYToIndex(TargetIndex.X, TargetIndex.Y) };
+	TargetCosts.Reset();
+	TargetVersion++;
+
+	MakeProblem(LastProblem, SharedField);
+	return true;
+}
+
+void AFlowFieldController::FinishBatchBuild()
+{
+	if (bWriteFieldToGrid) ApplySolution(Solution);
+
+	LastGridVersion = GridManager->GetGridVersion();
+	RetargetDrift = 0.f;
+	CrowdTimeSinceRebuild = 0.f;
+	UpdateMemoryStats();
+}
+
+void AFlowFieldController::UpdateMemoryStats()
+{
+	FlowMemory.Set(Solution.GetAllocatedSize() + Scratch.GetAllocatedSize() + LastProblem.GetAllocatedSize() +
+		RetargetDirtyCells.GetAllocatedSize() + TargetCells.GetAllocatedSize() + TargetCosts.GetAllocatedSize());
+}
+
+void AFlowFieldController::MakeProblem(FFlowFieldProblem& OutProblem, TSharedPtr<const FGridCostField> SharedField) const
+{
+	OutProblem = FFlowFieldProblem();
+	OutProblem.Field = SharedField.IsValid() ? SharedField : MakeShared<const FGridCostField>(GridManager->MakeCostField());
+	OutProblem.Sources = TargetCells;
+	OutProblem.SourceCosts = TargetCosts;
+	OutProblem.AnglePenalty = AnglePenalty;
+	OutProblem.Method = Method;
+
+	if (UnitRadius > 0.f)
+	{
+		OutProblem.MinClearance = GridManager->RadiusToClearance(UnitRadius);
+		OutProblem.Clearance = GridManager->GetClearanceField();
+	}
+
+	if (OccupancyWeight > 0.f || bContinuumCrowd)
+	{
+		OutProblem.Occupancy = GridManager->GetOccupancyField();
+		OutProblem.OccupancyWeight = OccupancyWeight;
+	}
+
+	if (bContinuumCrowd)
+	{
+		OutProblem.bContinuumCrowd = true;
+		OutProblem.DensityWeight = DensityWeight;
+		OutProblem.MinDensity = MinDensity;
+		OutProblem.MaxDensity = MaxDensity;
+		OutProblem.MaxSpeed = UnitMaxSpeed;
+
+		OutProblem.AverageVelocity.SetNumUninitialized(GridManager->Grid.Num());
+		for (int32 i = 0; i < GridManager->Grid.Num(); i++)
 		{
-			Cell.FlowDirection = FVector::ZeroVector;
+			OutProblem.AverageVelocity[i] = GridManager->GetAverageVelocity(i);
 		}
 	}
 }
 
+void AFlowFieldController::ApplySolution(const FFlowFieldSolution& InSolution)
+{
+	TArray<FGridCell>& Grid = GridManager->Grid;
+	if (InSolution.Num() != Grid.Num()) return;
+
+	for (int32 i = 0; i < Grid.Num(); i++)
+	{
+		Grid[i].IntegrationValue = InSolution.Integration[i];
+		Grid[i].FlowDirection = InSolution.GetDirection(i);
+	}
+}
+
+void AFlowFieldController::ApplySolutionCells(const FFlowFieldSolution& InSolution, const TArray<int32>& Cells)
+{
+	TArray<FGridCell>& Grid = GridManager->Grid;
+	if (InSolution.Num() != Grid.Num()) return;
+
+	for (const int32 Cell : Cells)
+	{
+		Grid[Cell].IntegrationValue = InSolution.Integration[Cell];
+		Grid[Cell].FlowDirection = InSolution.GetDirection(Cell);
+	}
+}
+
+void AFlowFieldController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bContinuumCrowd || !GridManager || GridManager->Grid.Num() == 0) return;
+
+	// Lockstep: every tick is one fixed step and rebuilds are applied on the tick that starts them
+	const bool bDeterministic = GridManager->bDeterministic;
+	CrowdTimeSinceRebuild += bDeterministic ? GridManager->DeterministicTimeStep : DeltaTime;
+	if (CrowdTimeSinceRebuild >= 1.f / FMath::Max(CrowdUpdateRate, 0.1f) && !bCrowdRebuildInFlight)
+	{
+		CrowdTimeSinceRebuild = 0.f;
+		if (bDeterministic) RebuildField();
+		else StartCrowdRebuild();
+	}
+}
+
+void AFlowFieldController::StartCrowdRebuild()
+{
+	TSharedRef<FFlowFieldProblem> Problem = MakeShared<FFlowFieldProblem>();
+	MakeProblem(*Problem);
+
+	bCrowdRebuildInFlight = true;
+
+	const int32 Version = GridManager->GetGridVersion();
+	const int32 Target = TargetVersion;
+	TWeakObjectPtr<AFlowFieldController> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Problem, Version, Target]()
+	{
+		TSharedRef<FFlowFieldSolution> Result = MakeShared<FFlowFieldSolution>();
+		FFlowFieldSolver::Solve(*Problem, *Result);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result, Version, Target]()
+		{
+			AFlowFieldController* Controller = WeakThis.Get();
+			if (!Controller) return;
+
+			Controller->bCrowdRebuildInFlight = false;
+
+			// The grid or the target changed while solving, the next rebuild will catch up
+			if (!Controller->GridManager || Controller->GridManager->GetGridVersion() != Version || Controller->TargetVersion != Target) return;
+
+			Controller->Solution = MoveTemp(*Result);
+			if (Controller->bWriteFieldToGrid) Controller->ApplySolution(Controller->Solution);
+			Controller->UpdateMemoryStats();
+
+			// LastProblem no longer matches Solution, so the next retarget has to rebuild
+			Controller->LastGridVersion = INDEX_NONE;
+		});
+	});
+}
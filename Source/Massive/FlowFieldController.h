@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "GridManager.h"
+#include "FlowFieldSolver.h"
 #include "GameFramework/Actor.h"
 #include "FlowFieldController.generated.h"
 
@@ -15,7 +16,11 @@ public:
 
 	AGridManager* GridManager;
 	
+	// Eikonal gives smooth directions instead of 8-way ones and doesn't need AnglePenalty
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField")
+	EFlowFieldMethod Method = EFlowFieldMethod::Wavefront;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField", meta=(EditCondition="Method==EFlowFieldMethod::Wavefront"))
 	float AnglePenalty = 1.f;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField")
@@ -23,22 +28,147 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField")
 	bool bDrawDebugPath = false;
+
+	// The field lives on the controller (GetFlowDirection / GetIntegration), so several
+	// controllers can hold fields on the same grid at once. This also copies it into the grid's
+	// cells, for AGridManager's debug drawing or code still reading FGridCell::FlowDirection;
+	// enable it on one controller per grid at most, the last one to build wins.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField")
+	bool bWriteFieldToGrid = false;
+
+	// Moving the single target a short way (a chased unit crossing a cell) only re-propagates
+	// the cells that get closer to it instead of rebuilding the whole field. Wavefront only.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Retarget")
+	bool bIncrementalRetarget = true;
+
+	// Targets further than this many cells from the previous one trigger a full rebuild
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Retarget", meta=(ClampMin="1", EditCondition="bIncrementalRetarget"))
+	int32 MaxRetargetDistance = 8;
+
+	// Far-away paths may run past earlier targets, adding up to the summed retarget drift.
+	// Once that passes this cost the field is rebuilt from scratch.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Retarget", meta=(ClampMin="0.0", EditCondition="bIncrementalRetarget"))
+	float MaxRetargetDrift = 32.f;
+
+	// Radius of the units following this field; cells without enough clearance are left out of it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField", meta=(ClampMin="0.0"))
+	float UnitRadius = 0.f;
+
+	// Extra integration cost per unit standing on a cell (0 = ignore the occupancy layer)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField", meta=(ClampMin="0.0"))
+	float OccupancyWeight = 0.f;
+	
+	// Continuum crowd mode: integration also weighs unit density and the crowd's velocity from
+	// the grid's occupancy layer (fed by AGridManager::UpdateOccupancyWithVelocities), so big groups
+	// spread over parallel corridors. The field is rebuilt in the background at CrowdUpdateRate and
+	// the previous one stays in use in between.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd")
+	bool bContinuumCrowd = false;
+
+	// Background rebuilds per second
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd", meta=(ClampMin="0.1", EditCondition="bContinuumCrowd"))
+	float CrowdUpdateRate = 5.f;
+
+	// Extra cost per unit in the cell being entered
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd", meta=(ClampMin="0.0", EditCondition="bContinuumCrowd"))
+	float DensityWeight = 1.f;
+
+	// Units per cell where the crowd starts to dictate speed, and where it fully does
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd", meta=(ClampMin="0.0", EditCondition="bContinuumCrowd"))
+	float MinDensity = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd", meta=(ClampMin="0.0", EditCondition="bContinuumCrowd"))
+	float MaxDensity = 2.f;
+
+	// Unit top speed (cm/s), crowd velocities are measured against it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FlowField|Crowd", meta=(ClampMin="1.0", EditCondition="bContinuumCrowd"))
+	float UnitMaxSpeed = 600.f;
 	
 	UFUNCTION(CallInEditor, BlueprintCallable, Category="FlowField")
 	TArray<FGridCell> const& SetTargetCellByWorldLocation(FVector const& WorldLocation);
 
+	// One field toward many cells at once ("any cell of this zone", "any of these buildings").
+	// InitialCosts is optional; a source's cost is added to every path that ends there, so
+	// higher values make it less attractive. Bad cells are skipped.
+	UFUNCTION(BlueprintCallable, Category="FlowField")
+	TArray<FGridCell> const& SetTargetCells(const TArray<FIntPoint>& Cells, const TArray<float>& InitialCosts);
+
+	UFUNCTION(BlueprintCallable, Category="FlowField")
+	TArray<FGridCell> const& SetTargetLocations(const TArray<FVector>& WorldLocations, const TArray<float>& InitialCosts);
+
+	// Every walkable cell whose center lies inside the box
+	UFUNCTION(BlueprintCallable, Category="FlowField")
+	TArray<FGridCell> const& SetTargetArea(const FBox& WorldArea);
+
+	// Batch builds (see UFlowFieldSubsystem::BuildFieldsBatch). BeginBatchBuild sets a new target
+	// and snapshots the build without running it, GetBuildProblem/GetBuildSolution are then solved
+	// on a worker, and FinishBatchBuild makes the result current on the game thread.
+	bool BeginBatchBuild(const FVector& TargetLocation, const TSharedPtr<const FGridCostField>& SharedField);
+	void FinishBatchBuild();
+	const FFlowFieldProblem& GetBuildProblem() const { return LastProblem; }
+	FFlowFieldSolution& GetBuildSolution() { return Solution; }
+
 	UFUNCTION(CallInEditor, BlueprintCallable, Category="FlowField")
 	FIntPoint WorldLocationToIndex(FVector const& WorldLocation);
 
+	// Direction to move in from Cell, zero outside the grid, on targets and before the first build
+	UFUNCTION(BlueprintPure, Category="FlowField")
+	FVector GetFlowDirection(const FIntPoint& Cell) const;
+
+	// Cost to reach the nearest target from Cell, TNumericLimits<float>::Max() if it can't be reached
+	UFUNCTION(BlueprintPure, Category="FlowField")
+	float GetIntegration(const FIntPoint& Cell) const;
+
+	// Reads this controller's field (see GetFlowDirection). OverrideGrid is only used before the
+	// controller has built a field for the current grid size.
 	UFUNCTION(CallInEditor, BlueprintCallable, Category="FlowField")
 	FVector GetFlowOfCell(const FIntPoint& index, const TArray<FGridCell>& OverrideGrid);
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void Tick(float DeltaTime) override;
 
 private:
 	
 	void SetTargetCell(int32 const& x, int32 const& y);
-	void ComputeIntegrationField();
-	void ComputeDirections();
+
+	// Rebuilds the field toward TargetCells
+	void RebuildField();
+
+	// Incremental move of a single-target field, false if it needs a full rebuild
+	bool TryRetarget(int32 NewTargetCell);
+
+	// Snapshot of the grid and settings for the current targets. Copies the grid's costs
+	// unless a cost field made from the same grid is passed in.
+	void MakeProblem(FFlowFieldProblem& OutProblem, TSharedPtr<const FGridCostField> SharedField = nullptr) const;
+
+	// Copies a solved field into the grid cells (bWriteFieldToGrid only)
+	void ApplySolution(const FFlowFieldSolution& Solution);
+	void ApplySolutionCells(const FFlowFieldSolution& Solution, const TArray<int32>& Cells);
+
+	void StartCrowdRebuild();
+
+	// Reports the buffers below to FMassiveMemory
+	void UpdateMemoryStats();
+	FMassiveMemoryCounter FlowMemory{EMassiveMemory::FlowField};
+
+	// The current field, reused by synchronous builds
+	FFlowFieldSolution Solution;
+	FFlowFieldScratch Scratch;
+
+	// Input of the last synchronous build, kept for retargeting
+	FFlowFieldProblem LastProblem;
+	int32 LastGridVersion = INDEX_NONE;
+	float RetargetDrift = 0.f;
+	TArray<int32> RetargetDirtyCells;
+
+	// Flattened cells and initial costs the current field flows toward
+	TArray<int32> TargetCells;
+	TArray<float> TargetCosts;
+
+	// Bumped whenever the targets change, so stale background builds are dropped
+	int32 TargetVersion = 0;
+
+	float CrowdTimeSinceRebuild = 0.f;
+	bool bCrowdRebuildInFlight = false;
 };
@@ -0,0 +1,652 @@
+#include "FlowFieldSolver.h"
+#include "MassiveStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+	// Side of the square blocks the Eikonal sweeps are split into
+	constexpr int32 EikonalBlockSize = 32;
+
+	// tan(15 degrees)
+	constexpr float CardinalSlopeLimit = 0.26794919f;
+
+	// Rows per ParallelFor task in the direction pass
+	constexpr int32 DirectionRowsPerTask = 16;
+}
+
+const FVector FFlowFieldSolver::DirectionVectors[9] =
+{
+	FVector(0.f, 1.f, 0.f), FVector(0.f, -1.f, 0.f), FVector(-1.f, 0.f, 0.f), FVector(1.f, 0.f, 0.f),
+	FVector(-UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.f), FVector(UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.f),
+	FVector(UE_INV_SQRT_2, UE_INV_SQRT_2, 0.f), FVector(-UE_INV_SQRT_2, UE_INV_SQRT_2, 0.f),
+	FVector::ZeroVector
+};
+
+FVector FFlowFieldSolution::GetDirection(int32 Cell) const
+{
+	if (DirectionIndices.IsValidIndex(Cell)) return FFlowFieldSolver::DirectionVectors[DirectionIndices[Cell]];
+	return Directions.IsValidIndex(Cell) ? Directions[Cell] : FVector::ZeroVector;
+}
+
+void FFlowFieldSolver::Solve(const FFlowFieldProblem& Problem, FFlowFieldSolution& OutSolution)
+{
+	FFlowFieldScratch Scratch;
+	Solve(Problem, OutSolution, Scratch);
+}
+
+void FFlowFieldSolver::Solve(const FFlowFieldProblem& Problem, FFlowFieldSolution& OutSolution, FFlowFieldScratch& Scratch)
+{
+	LLM_SCOPE_BYTAG(Massive_FlowField);
+
+	if (!Problem.Field.IsValid())
+	{
+		OutSolution = FFlowFieldSolution();
+		return;
+	}
+
+	if (Problem.Method == EFlowFieldMethod::Eikonal)
+	{
+		ComputeEikonal(Problem, OutSolution.Integration);
+		ComputeGradientDirections(Problem.GetField(), OutSolution.Integration, OutSolution.Directions);
+		OutSolution.DirectionIndices.Reset();
+		return;
+	}
+
+	ComputeIntegration(Problem, OutSolution.Integration, Scratch);
+	ComputeDirections(Problem.GetField(), OutSolution);
+	OutSolution.Directions.Reset();
+}
+
+void FFlowFieldSolver::SolveBatch(TArrayView<const FFlowFieldProblem* const> Problems, TArrayView<FFlowFieldSolution* const> Solutions,
+	TArray<FFlowFieldScratch>& Scratch)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowBatch);
+	LLM_SCOPE_BYTAG(Massive_FlowField);
+
+	check(Problems.Num() == Solutions.Num());
+	if (Problems.Num() == 0) return;
+
+	const int32 NumWorkers = FMath::Min(Problems.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	if (Scratch.Num() < NumWorkers) Scratch.SetNum(NumWorkers);
+
+	// Workers pull the next field as they finish, builds can differ a lot in size
+	int32 NextProblem = -1;
+	ParallelFor(NumWorkers, [&](int32 Worker)
+	{
+		for (int32 i = FPlatformAtomics::InterlockedIncrement(&NextProblem); i < Problems.Num(); i = FPlatformAtomics::InterlockedIncrement(&NextProblem))
+		{
+			Solve(*Problems[i], *Solutions[i], Scratch[Worker]);
+		}
+	});
+}
+
+float FFlowFieldSolver::StepCost(const FFlowFieldProblem& Problem, int32 From, int32 To, int32 Source)
+{
+	const FGridCostField& Field = Problem.GetField();
+	const int32 FromX = From % Field.Width;
+	const int32 FromY = From / Field.Width;
+
+	const int32 TargetX = Source % Field.Width;
+	const int32 TargetY = Source / Field.Width;
+
+	// If an angle is 15 degrees more than a cardinal direction we consider it 'diagonal' and add a cost to it.
+	// Same test as comparing Atan2 against the nearest cardinal, done on the slope instead.
+	const int32 MinorAxis = FMath::Min(FMath::Abs(TargetX - FromX), FMath::Abs(TargetY - FromY));
+	const int32 MajorAxis = FMath::Max(FMath::Abs(TargetX - FromX), FMath::Abs(TargetY - FromY));
+
+	float Cost = Field.Costs[From];
+	if (MinorAxis > CardinalSlopeLimit * MajorAxis) Cost += Problem.AnglePenalty;
+
+	if (Problem.OccupancyWeight > 0.f && Problem.Occupancy.IsValidIndex(From))
+	{
+		Cost += Problem.OccupancyWeight * Problem.Occupancy[From];
+	}
+
+	if (Problem.bContinuumCrowd && Problem.Occupancy.IsValidIndex(To) && Problem.AverageVelocity.IsValidIndex(To))
+	{
+		const float Density = float(Problem.Occupancy[To]);
+
+		// Speed along the move: free-flowing at low density, the crowd's speed in our direction at high density
+		const FVector2f MoveDir = FVector2f(float(To % Field.Width - FromX), float(To / Field.Width - FromY)).GetSafeNormal();
+		const float FlowSpeed = FMath::Clamp(FVector2f::DotProduct(Problem.AverageVelocity[To], MoveDir) / FMath::Max(Problem.MaxSpeed, 1.f), 0.05f, 1.f);
+		const float Blend = FMath::Clamp((Density - Problem.MinDensity) / FMath::Max(Problem.MaxDensity - Problem.MinDensity, KINDA_SMALL_NUMBER), 0.f, 1.f);
+		const float Speed = FMath::Lerp(1.f, FlowSpeed, Blend);
+
+		Cost = (Cost + Problem.DensityWeight * Density) / Speed;
+	}
+
+	return Cost;
+}
+
+void FFlowFieldSolver::ComputeIntegration(const FFlowFieldProblem& Problem, TArray<float>& OutIntegration, FFlowFieldScratch& Scratch)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowIntegration);
+
+	const FGridCostField& Field = Problem.GetField();
+	const int32 NumCells = Field.Num();
+
+	// Reset all integration values
+	OutIntegration.Init(FLT_MAX, NumCells);
+	if (NumCells == 0) return;
+
+	const bool bFilterClearance = Problem.MinClearance > 1 && Problem.Clearance.Num() == NumCells;
+
+	TArray<int32>& Origins = Scratch.Origins;
+	Origins.Init(INDEX_NONE, NumCells);
+
+	// A cell that is already queued just gets its value lowered in place,
+	// so the ring never holds more than one entry per cell
+	TArray<int32>& Queue = Scratch.Queue;
+	TArray<uint8>& InQueue = Scratch.InQueue;
+	Queue.SetNumUninitialized(NumCells);
+	InQueue.Init(0, NumCells);
+
+	int32 Head = 0;
+	int32 QueuedCount = 0;
+	auto Enqueue = [&](int32 Cell)
+	{
+		if (InQueue[Cell]) return;
+		InQueue[Cell] = 1;
+
+		int32 Tail = Head + QueuedCount;
+		if (Tail >= NumCells) Tail -= NumCells;
+		Queue[Tail] = Cell;
+		QueuedCount++;
+	};
+
+	for (int32 i = 0; i < Problem.Sources.Num(); i++)
+	{
+		const int32 Source = Problem.Sources[i];
+		if (!Field.Costs.IsValidIndex(Source)) continue;
+
+		const float SourceCost = Problem.GetSourceCost(i);
+		if (SourceCost >= OutIntegration[Source]) continue;
+
+		OutIntegration[Source] = SourceCost;
+		Origins[Source] = Source;
+		Enqueue(Source);
+	}
+
+	int32 Neighbors[8];
+	bool IsDiagonal[8];
+
+	while (QueuedCount > 0)
+	{
+		const int32 Current = Queue[Head];
+		InQueue[Current] = 0;
+		QueuedCount--;
+		if (++Head == NumCells) Head = 0;
+
+		const int32 Count = Field.GetNeighbors(Current, Neighbors, IsDiagonal);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Neighbor = Neighbors[i];
+
+			// Too narrow for these units: stays at FLT_MAX, so units that end up there still flow out
+			if (bFilterClearance && Problem.Clearance[Neighbor] < Problem.MinClearance) continue;
+
+			const float NewCost = OutIntegration[Current] + StepCost(Problem, Neighbor, Current, Origins[Current]);
+			if (NewCost < OutIntegration[Neighbor])
+			{
+				OutIntegration[Neighbor] = NewCost;
+				Origins[Neighbor] = Origins[Current];
+				Enqueue(Neighbor);
+			}
+		}
+	}
+}
+
+void FFlowFieldSolver::ComputeDirections(const FGridCostField& Field, FFlowFieldSolution& InOutSolution)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowDirections);
+
+	const int32 Width = Field.Width;
+	const int32 Height = Field.Height;
+	const TArray<float>& Integration = InOutSolution.Integration;
+	TArray<uint8>& OutIndices = InOutSolution.DirectionIndices;
+	OutIndices.SetNumUninitialized(Field.Num());
+	if (Field.Num() == 0) return;
+
+	// Rows are padded to a multiple of 4 plus a border column each side, so every 4-wide load
+	// of a neighbor row stays inside the plane. Walls are 0 for walkable cells and FLT_MAX
+	// otherwise, which lets the corner-cutting rule be applied with a max.
+	const int32 Stride = Align(Width, 4) + 2;
+	TArray<float>& Padded = InOutSolution.PaddedIntegration;
+	TArray<float>& Walls = InOutSolution.PaddedWalls;
+	Padded.SetNumUninitialized(Stride * (Height + 2));
+	Walls.SetNumUninitialized(Stride * (Height + 2));
+
+	ParallelFor(Height + 2, [&](int32 PY)
+	{
+		float* PaddedRow = Padded.GetData() + PY * Stride;
+		float* WallRow = Walls.GetData() + PY * Stride;
+		const int32 Y = PY - 1;
+
+		for (int32 PX = 0; PX < Stride; PX++)
+		{
+			const int32 X = PX - 1;
+			if (Y < 0 || Y >= Height || X < 0 || X >= Width)
+			{
+				PaddedRow[PX] = FLT_MAX;
+				WallRow[PX] = FLT_MAX;
+				continue;
+			}
+
+			const int32 Cell = Y * Width + X;
+			PaddedRow[PX] = Integration[Cell];
+			WallRow[PX] = Field.IsWalkable(Cell) ? 0.f : FLT_MAX;
+		}
+	});
+
+	// Neighbor offsets in the padded plane, in NeighborOffsets order
+	int32 Offsets[8];
+	for (int32 i = 0; i < 8; i++)
+	{
+		Offsets[i] = FGridCostField::NeighborOffsets[i][1] * Stride + FGridCostField::NeighborOffsets[i][0];
+	}
+
+	const int32 NumTasks = FMath::DivideAndRoundUp(Height, DirectionRowsPerTask);
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		const int32 FirstRow = Task * DirectionRowsPerTask;
+		const int32 LastRow = FMath::Min(FirstRow + DirectionRowsPerTask, Height);
+
+		for (int32 Y = FirstRow; Y < LastRow; Y++)
+		{
+			for (int32 X = 0; X < Width; X += 4)
+			{
+				const float* Center = Padded.GetData() + (Y + 1) * Stride + X + 1;
+				const float* CenterWall = Walls.GetData() + (Y + 1) * Stride + X + 1;
+
+				VectorRegister4Float Best = VectorLoad(Center);
+				VectorRegister4Float BestIndex = VectorSetFloat1(float(NoDirection));
+
+				// Cardinals first and strict less-than, so ties resolve like GetNeighbors order
+				for (int32 i = 0; i < 8; i++)
+				{
+					VectorRegister4Float Value = VectorMax(VectorLoad(Center + Offsets[i]), VectorLoad(CenterWall + Offsets[i]));
+					if (i >= 4)
+					{
+						// Diagonals need both cardinals they cut past to be walkable
+						const int32 DX = FGridCostField::NeighborOffsets[i][0];
+						const int32 DY = FGridCostField::NeighborOffsets[i][1] * Stride;
+						Value = VectorMax(Value, VectorMax(VectorLoad(CenterWall + DX), VectorLoad(CenterWall + DY)));
+					}
+
+					const VectorRegister4Float Mask = VectorCompareLT(Value, Best);
+					Best = VectorSelect(Mask, Value, Best);
+					BestIndex = VectorSelect(Mask, VectorSetFloat1(float(i)), BestIndex);
+				}
+
+				alignas(16) float Indices[4];
+				VectorStoreAligned(BestIndex, Indices);
+
+				const int32 Count = FMath::Min(4, Width - X);
+				uint8* Out = OutIndices.GetData() + Y * Width + X;
+				for (int32 i = 0; i < Count; i++)
+				{
+					Out[i] = uint8(Indices[i]);
+				}
+			}
+		}
+	});
+}
+
+FVector FFlowFieldSolver::SteepestNeighborDirection(const FGridCostField& Field, const TArray<float>& Integration, int32 Cell)
+{
+	return DirectionVectors[SteepestNeighborIndex(Field, Integration, Cell)];
+}
+
+uint8 FFlowFieldSolver::SteepestNeighborIndex(const FGridCostField& Field, const TArray<float>& Integration, int32 Cell)
+{
+	const int32 X = Cell % Field.Width;
+	const int32 Y = Cell / Field.Width;
+
+	uint8 BestIndex = NoDirection;
+	float BestCost = Integration[Cell];
+
+	// Same walk as GetNeighbors, but keeping the offset index
+	for (int32 i = 0; i < 8; i++)
+	{
+		const int32 NX = X + FGridCostField::NeighborOffsets[i][0];
+		const int32 NY = Y + FGridCostField::NeighborOffsets[i][1];
+		if (!Field.IsInside(NX, NY)) continue;
+
+		const int32 Neighbor = Field.XYToIndex(NX, NY);
+		if (!Field.IsWalkable(Neighbor)) continue;
+		if (i >= 4 && (!Field.IsWalkable(Field.XYToIndex(NX, Y)) || !Field.IsWalkable(Field.XYToIndex(X, NY)))) continue;
+
+		if (Integration[Neighbor] < BestCost)
+		{
+			BestIndex = uint8(i);
+			BestCost = Integration[Neighbor];
+		}
+	}
+
+	return BestIndex;
+}
+
+bool FFlowFieldSolver::Reroot(FFlowFieldProblem& InOutProblem, FFlowFieldSolution& InOutSolution, int32 NewSource,
+	FFlowFieldScratch& Scratch, float& OutDrift, TArray<int32>& OutDirtyCells)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowReroot);
+	LLM_SCOPE_BYTAG(Massive_FlowField);
+
+	OutDrift = 0.f;
+	OutDirtyCells.Reset();
+	if (!InOutProblem.Field.IsValid()) return false;
+
+	const FGridCostField& Field = InOutProblem.GetField();
+	const int32 NumCells = Field.Num();
+	TArray<float>& Integration = InOutSolution.Integration;
+
+	if (InOutProblem.Method != EFlowFieldMethod::Wavefront || InOutProblem.Sources.Num() != 1) return false;
+	if (Integration.Num() != NumCells || InOutSolution.DirectionIndices.Num() != NumCells) return false;
+	if (!Field.Costs.IsValidIndex(NewSource)) return false;
+
+	const int32 OldSource = InOutProblem.Sources[0];
+	const float OldValue = Integration[OldSource];
+	if (NewSource == OldSource) return true;
+
+	// Only a new source the old field already reaches can be rerooted to
+	if (Integration[NewSource] == FLT_MAX) return false;
+	const float Distance = Integration[NewSource] - OldValue;
+
+	// Going back to the old source can cost a bit more than coming from it (costs are paid on
+	// leaving a cell, plus the angle penalty), so seed with that much slack
+	const float Slack = FMath::Max(0, Field.Costs[OldSource]) + InOutProblem.AnglePenalty;
+	const float Seed = OldValue - Distance - Slack;
+
+	const bool bFilterClearance = InOutProblem.MinClearance > 1 && InOutProblem.Clearance.Num() == NumCells;
+
+	// Same ring as ComputeIntegration. Both leave InQueue all zero, so it only needs clearing
+	// when its size changed, which keeps the reroot proportional to the cells it touches.
+	TArray<int32>& Queue = Scratch.Queue;
+	TArray<uint8>& Flags = Scratch.InQueue;
+	if (Queue.Num() != NumCells) Queue.SetNumUninitialized(NumCells);
+	if (Flags.Num() != NumCells) Flags.Init(0, NumCells);
+
+	constexpr uint8 QueuedFlag = 1;
+	constexpr uint8 DirtyFlag = 2;
+
+	int32 Head = 0;
+	int32 QueuedCount = 0;
+	auto Enqueue = [&](int32 Cell)
+	{
+		if (Flags[Cell] & QueuedFlag) return;
+		Flags[Cell] |= QueuedFlag;
+
+		int32 Tail = Head + QueuedCount;
+		if (Tail >= NumCells) Tail -= NumCells;
+		Queue[Tail] = Cell;
+		QueuedCount++;
+	};
+
+	// Directions change for the updated cells and whoever looks at them, each listed once
+	auto MarkDirty = [&](int32 Cell)
+	{
+		if (Flags[Cell] & DirtyFlag) return;
+		Flags[Cell] |= DirtyFlag;
+		OutDirtyCells.Add(Cell);
+	};
+	auto MarkChanged = [&](int32 Cell)
+	{
+		MarkDirty(Cell);
+
+		const int32 X = Cell % Field.Width;
+		const int32 Y = Cell / Field.Width;
+		for (int32 i = 0; i < 8; i++)
+		{
+			const int32 NX = X + FGridCostField::NeighborOffsets[i][0];
+			const int32 NY = Y + FGridCostField::NeighborOffsets[i][1];
+			if (Field.IsInside(NX, NY)) MarkDirty(Field.XYToIndex(NX, NY));
+		}
+	};
+
+	Integration[NewSource] = Seed;
+	MarkChanged(NewSource);
+	Enqueue(NewSource);
+
+	int32 Neighbors[8];
+	bool IsDiagonal[8];
+
+	while (QueuedCount > 0)
+	{
+		const int32 Current = Queue[Head];
+		Flags[Current] &= ~QueuedFlag;
+		QueuedCount--;
+		if (++Head == NumCells) Head = 0;
+
+		const int32 Count = Field.GetNeighbors(Current, Neighbors, IsDiagonal);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Neighbor = Neighbors[i];
+			if (bFilterClearance && InOutProblem.Clearance[Neighbor] < InOutProblem.MinClearance) continue;
+
+			// Only decreases are propagated, which is what keeps this local
+			const float NewCost = Integration[Current] + StepCost(InOutProblem, Neighbor, Current, NewSource);
+			if (NewCost < Integration[Neighbor])
+			{
+				Integration[Neighbor] = NewCost;
+				MarkChanged(Neighbor);
+				Enqueue(Neighbor);
+			}
+		}
+	}
+
+	for (const int32 Cell : OutDirtyCells)
+	{
+		Flags[Cell] = 0;
+	}
+
+	// The old source must now lead on to the new one, or it would stay a sink of its own.
+	// Integration is already partly rerooted at this point, the caller has to Solve again.
+	if (Integration[OldSource] >= OldValue)
+	{
+		OutDirtyCells.Reset();
+		return false;
+	}
+
+	InOutProblem.Sources[0] = NewSource;
+	InOutProblem.SourceCosts = { Seed };
+	OutDrift = Distance + Slack;
+
+	for (const int32 Cell : OutDirtyCells)
+	{
+		InOutSolution.DirectionIndices[Cell] = SteepestNeighborIndex(Field, Integration, Cell);
+	}
+
+	return true;
+}
+
+float FFlowFieldSolver::CellCost(const FFlowFieldProblem& Problem, int32 Cell)
+{
+	float Cost = float(Problem.GetField().Costs[Cell]);
+	if (Cost < 0.f) return -1.f;
+
+	if (Problem.MinClearance > 1 && Problem.Clearance.IsValidIndex(Cell) && Problem.Clearance[Cell] < Problem.MinClearance)
+	{
+		return -1.f;
+	}
+
+	if (Problem.Occupancy.IsValidIndex(Cell))
+	{
+		const float Weight = Problem.OccupancyWeight + (Problem.bContinuumCrowd ? Problem.DensityWeight : 0.f);
+		Cost += Weight * Problem.Occupancy[Cell];
+	}
+
+	return Cost;
+}
+
+void FFlowFieldSolver::ComputeEikonal(const FFlowFieldProblem& Problem, TArray<float>& OutDistance)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowEikonal);
+
+	const FGridCostField& Field = Problem.GetField();
+	const int32 Width = Field.Width;
+	const int32 Height = Field.Height;
+
+	OutDistance.Init(FLT_MAX, Field.Num());
+
+	TArray<float> Costs;
+	Costs.SetNumUninitialized(Field.Num());
+	ParallelFor(Height, [&](int32 Y)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			const int32 Cell = Y * Width + X;
+			Costs[Cell] = CellCost(Problem, Cell);
+		}
+	});
+
+	// Sources are the boundary condition. The ones with the lowest starting cost can't get any
+	// closer and are never updated, the others may still be reached cheaper from another source.
+	float MinSourceCost = FLT_MAX;
+	for (int32 i = 0; i < Problem.Sources.Num(); i++)
+	{
+		const int32 Source = Problem.Sources[i];
+		if (!Field.Costs.IsValidIndex(Source)) continue;
+
+		const float SourceCost = Problem.GetSourceCost(i);
+		OutDistance[Source] = FMath::Min(OutDistance[Source], SourceCost);
+		MinSourceCost = FMath::Min(MinSourceCost, SourceCost);
+	}
+
+	for (const int32 Source : Problem.Sources)
+	{
+		if (Field.Costs.IsValidIndex(Source) && OutDistance[Source] <= MinSourceCost) Costs[Source] = -1.f;
+	}
+
+	const int32 BlocksX = FMath::DivideAndRoundUp(Width, EikonalBlockSize);
+	const int32 BlocksY = FMath::DivideAndRoundUp(Height, EikonalBlockSize);
+
+	// Largest decrease per block in the current round
+	TArray<float> BlockChange;
+	BlockChange.SetNumZeroed(BlocksX * BlocksY);
+
+	float* Distance = OutDistance.GetData();
+
+	// Godunov upwind update of one cell, returns how much it decreased
+	auto UpdateCell = [&](int32 X, int32 Y) -> float
+	{
+		const int32 Cell = Y * Width + X;
+		const float Cost = Costs[Cell];
+		if (Cost < 0.f) return 0.f;
+
+		const float A = FMath::Min(X > 0 ? Distance[Cell - 1] : FLT_MAX, X < Width - 1 ? Distance[Cell + 1] : FLT_MAX);
+		const float B = FMath::Min(Y > 0 ? Distance[Cell - Width] : FLT_MAX, Y < Height - 1 ? Distance[Cell + Width] : FLT_MAX);
+		if (A == FLT_MAX && B == FLT_MAX) return 0.f;
+
+		// One-sided when the other axis is too far behind to contribute (or unreachable)
+		const float NewDistance = FMath::Abs(A - B) >= Cost
+			? FMath::Min(A, B) + Cost
+			: 0.5f * (A + B + FMath::Sqrt(2.f * Cost * Cost - (A - B) * (A - B)));
+
+		const float OldDistance = Distance[Cell];
+		if (NewDistance >= OldDistance) return 0.f;
+
+		Distance[Cell] = NewDistance;
+		return OldDistance == FLT_MAX ? FLT_MAX : OldDistance - NewDistance;
+	};
+
+	for (int32 Iteration = 0; Iteration < Problem.MaxSweepIterations; Iteration++)
+	{
+		for (int32 Sweep = 0; Sweep < 4; Sweep++)
+		{
+			const bool bFlipX = (Sweep & 1) != 0;
+			const bool bFlipY = (Sweep & 2) != 0;
+
+			// Blocks on one anti-diagonal only touch each other at corners, which the
+			// 4-neighbor update never reads, so each wave can run in parallel
+			for (int32 Wave = 0; Wave < BlocksX + BlocksY - 1; Wave++)
+			{
+				const int32 FirstBX = FMath::Max(0, Wave - (BlocksY - 1));
+				const int32 LastBX = FMath::Min(Wave, BlocksX - 1);
+
+				ParallelFor(LastBX - FirstBX + 1, [&](int32 i)
+				{
+					const int32 WaveBX = FirstBX + i;
+					const int32 WaveBY = Wave - WaveBX;
+					const int32 BX = bFlipX ? BlocksX - 1 - WaveBX : WaveBX;
+					const int32 BY = bFlipY ? BlocksY - 1 - WaveBY : WaveBY;
+
+					const int32 X0 = BX * EikonalBlockSize;
+					const int32 Y0 = BY * EikonalBlockSize;
+					const int32 X1 = FMath::Min(X0 + EikonalBlockSize, Width) - 1;
+					const int32 Y1 = FMath::Min(Y0 + EikonalBlockSize, Height) - 1;
+
+					float Change = 0.f;
+					for (int32 Row = 0; Row <= Y1 - Y0; Row++)
+					{
+						const int32 Y = bFlipY ? Y1 - Row : Y0 + Row;
+						for (int32 Col = 0; Col <= X1 - X0; Col++)
+						{
+							const int32 X = bFlipX ? X1 - Col : X0 + Col;
+							Change = FMath::Max(Change, UpdateCell(X, Y));
+						}
+					}
+
+					float& Block = BlockChange[BY * BlocksX + BX];
+					Block = FMath::Max(Block, Change);
+				});
+			}
+		}
+
+		float MaxChange = 0.f;
+		for (float& Change : BlockChange)
+		{
+			MaxChange = FMath::Max(MaxChange, Change);
+			Change = 0.f;
+		}
+
+		if (MaxChange <= Problem.SweepTolerance) break;
+	}
+}
+
+void FFlowFieldSolver::ComputeGradientDirections(const FGridCostField& Field, const TArray<float>& Distance, TArray<FVector>& OutDirections)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_FlowDirections);
+
+	const int32 Width = Field.Width;
+	const int32 Height = Field.Height;
+	OutDirections.SetNumUninitialized(Field.Num());
+
+	// Derivative along one axis from whichever neighbor is closer to the target
+	auto Upwind = [&Distance](int32 Lower, int32 Upper, float Center) -> float
+	{
+		const float DLower = Lower != INDEX_NONE ? Distance[Lower] : FLT_MAX;
+		const float DUpper = Upper != INDEX_NONE ? Distance[Upper] : FLT_MAX;
+
+		if (DLower < DUpper && DLower < Center) return Center - DLower;
+		if (DUpper < Center) return DUpper - Center;
+		return 0.f;
+	};
+
+	ParallelFor(Height, [&](int32 Y)
+	{
+		for (int32 X = 0; X < Width; X++)
+		{
+			const int32 Cell = Y * Width + X;
+			const float Center = Distance[Cell];
+
+			if (!Field.IsWalkable(Cell))
+			{
+				OutDirections[Cell] = FVector::ZeroVector;
+				continue;
+			}
+
+			// Unreachable cells have no gradient, step them out toward any reached neighbor
+			if (Center == FLT_MAX)
+			{
+				OutDirections[Cell] = SteepestNeighborDirection(Field, Distance, Cell);
+				continue;
+			}
+
+			const float GradX = Upwind(X > 0 ? Cell - 1 : INDEX_NONE, X < Width - 1 ? Cell + 1 : INDEX_NONE, Center);
+			const float GradY = Upwind(Y > 0 ? Cell - Width : INDEX_NONE, Y < Height - 1 ? Cell + Width : INDEX_NONE, Center);
+
+			OutDirections[Cell] = FVector(-GradX, -GradY, 0.f).GetSafeNormal();
+		}
+	});
+}
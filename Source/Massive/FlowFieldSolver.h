@@ -0,0 +1,159 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCostField.h"
+#include "FlowFieldSolver.generated.h"
+
+UENUM(BlueprintType)
+enum class EFlowFieldMethod : uint8
+{
+	// Breadth-first relaxation over the 8 neighbors, directions snap to the steepest neighbor
+	Wavefront,
+	// Fast-sweeping Eikonal solve, continuous distances and directions from their gradient
+	Eikonal
+};
+
+// Everything a flow field build needs, copied off the grid so it can be solved on any thread
+struct FFlowFieldProblem
+{
+	// Read-only, so batch builds over the same grid can share one copy
+	TSharedPtr<const FGridCostField> Field;
+
+	// Cells the field flows toward. Units follow it to whichever source is cheapest to reach,
+	// counting that source's entry in SourceCosts (optional, 0 when missing) as a head start
+	// against it, e.g. for goal priorities or influence maps.
+	TArray<int32> Sources;
+	TArray<float> SourceCosts;
+
+	// Extra cost for moves more than 15 degrees off a cardinal direction toward the source they lead to
+	float AnglePenalty = 1.f;
+
+	// Optional per-cell planes, left empty when unused
+	TArray<uint8> Clearance;
+	int32 MinClearance = 0;
+
+	TArray<int32> Occupancy;
+	float OccupancyWeight = 0.f;
+
+	// Continuum crowd: moving into a crowded cell costs more, and once density passes
+	// MinDensity the speed there blends toward the crowd's own velocity along the move,
+	// so units avoid pushing against the flow. Needs Occupancy and AverageVelocity.
+	bool bContinuumCrowd = false;
+	TArray<FVector2f> AverageVelocity;
+	float DensityWeight = 1.f;
+	float MinDensity = 0.5f;
+	float MaxDensity = 2.f;
+	float MaxSpeed = 600.f;
+
+	EFlowFieldMethod Method = EFlowFieldMethod::Wavefront;
+
+	// Eikonal: full rounds of the four sweep orders before giving up on convergence,
+	// and the largest change in a round that still counts as converged
+	int32 MaxSweepIterations = 32;
+	float SweepTolerance = 0.01f;
+
+	FORCEINLINE const FGridCostField& GetField() const { return *Field; }
+
+	// Includes the cost field, even when it is shared with other problems
+	SIZE_T GetAllocatedSize() const
+	{
+		return (Field.IsValid() ? Field->GetAllocatedSize() : 0) + Sources.GetAllocatedSize() + SourceCosts.GetAllocatedSize() +
+			Clearance.GetAllocatedSize() + Occupancy.GetAllocatedSize() + AverageVelocity.GetAllocatedSize();
+	}
+
+	FORCEINLINE float GetSourceCost(int32 SourceIndex) const
+	{
+		return SourceCosts.IsValidIndex(SourceIndex) ? SourceCosts[SourceIndex] : 0.f;
+	}
+};
+
+struct FFlowFieldSolution
+{
+	TArray<float> Integration;
+
+	// Wavefront: index into FFlowFieldSolver::DirectionVectors per cell
+	TArray<uint8> DirectionIndices;
+
+	// Eikonal: continuous direction per cell
+	TArray<FVector> Directions;
+
+	// Integration and walls with a one-cell border, reused between builds
+	TArray<float> PaddedIntegration;
+	TArray<float> PaddedWalls;
+
+	FORCEINLINE int32 Num() const { return Integration.Num(); }
+	FVector GetDirection(int32 Cell) const;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Integration.GetAllocatedSize() + DirectionIndices.GetAllocatedSize() + Directions.GetAllocatedSize() +
+			PaddedIntegration.GetAllocatedSize() + PaddedWalls.GetAllocatedSize();
+	}
+};
+
+// Per-worker buffers for the wavefront, kept between builds so they only grow once
+struct FFlowFieldScratch
+{
+	// Ring buffer of cells to relax, each cell is queued at most once at a time. InQueue is all
+	// zero between calls (Reroot also keeps a dirty bit in it while it runs).
+	TArray<int32> Queue;
+	TArray<uint8> InQueue;
+
+	// Source each cell's value came from
+	TArray<int32> Origins;
+
+	SIZE_T GetAllocatedSize() const { return Queue.GetAllocatedSize() + InQueue.GetAllocatedSize() + Origins.GetAllocatedSize(); }
+};
+
+class MASSIVE_API FFlowFieldSolver
+{
+public:
+	// Unit vectors in FGridCostField::NeighborOffsets order, NoDirection maps to zero
+	static constexpr uint8 NoDirection = 8;
+	static const FVector DirectionVectors[9];
+
+	// Integration field from all sources in one pass, then a direction per cell toward its lowest neighbor.
+	// OutSolution's arrays are reused, so keeping one around avoids reallocating per build.
+	static void Solve(const FFlowFieldProblem& Problem, FFlowFieldSolution& OutSolution);
+	static void Solve(const FFlowFieldProblem& Problem, FFlowFieldSolution& OutSolution, FFlowFieldScratch& Scratch);
+
+	// Solves several fields at once, one worker per field. Scratch holds one entry per worker
+	// and is grown as needed, so reusing it across batches avoids reallocating the queues.
+	static void SolveBatch(TArrayView<const FFlowFieldProblem* const> Problems, TArrayView<FFlowFieldSolution* const> Solutions,
+		TArray<FFlowFieldScratch>& Scratch);
+
+	static void ComputeIntegration(const FFlowFieldProblem& Problem, TArray<float>& OutIntegration, FFlowFieldScratch& Scratch);
+	// Steepest-descent neighbor per cell, as an index into DirectionVectors. Rows are split
+	// across workers and the 8-neighbor minimum is taken 4 cells at a time from padded planes.
+	static void ComputeDirections(const FGridCostField& Field, FFlowFieldSolution& InOutSolution);
+
+	// Moves a single-source wavefront field to NewSource without rebuilding it. NewSource is seeded
+	// below the old source's value and only cells that get closer to it are re-propagated, so the
+	// work is proportional to the region that changed. Cells further out keep their old values and
+	// reach NewSource by way of the old source, which can make their paths up to OutDrift longer.
+	// Integration values stop being distances (only their order matters to the directions).
+	// OutDirtyCells lists each cell whose value or direction may have changed once.
+	// Returns false if the field can't be rerooted. The solution may already be partly updated
+	// then and is invalid until it is rebuilt with Solve.
+	static bool Reroot(FFlowFieldProblem& InOutProblem, FFlowFieldSolution& InOutSolution, int32 NewSource,
+		FFlowFieldScratch& Scratch, float& OutDrift, TArray<int32>& OutDirtyCells);
+
+	// Solves |grad T| = cost with fast sweeping. The grid is cut into blocks and each sweep
+	// walks the blocks in anti-diagonal waves, so blocks of one wave are updated in parallel
+	// and the result matches a plain serial sweep. The crowd's velocity is direction dependent
+	// and can't be expressed as a cell cost, so only density counts here.
+	static void ComputeEikonal(const FFlowFieldProblem& Problem, TArray<float>& OutDistance);
+
+	// Directions along -grad T, using the upwind neighbor on each axis
+	static void ComputeGradientDirections(const FGridCostField& Field, const TArray<float>& Distance, TArray<FVector>& OutDirections);
+
+private:
+	// Cost for a unit in From to step into To, on its way to Source
+	static float StepCost(const FFlowFieldProblem& Problem, int32 From, int32 To, int32 Source);
+
+	// Isotropic cost of crossing a cell for the Eikonal solve, < 0 if it can't be entered
+	static float CellCost(const FFlowFieldProblem& Problem, int32 Cell);
+
+	static FVector SteepestNeighborDirection(const FGridCostField& Field, const TArray<float>& Integration, int32 Cell);
+	static uint8 SteepestNeighborIndex(const FGridCostField& Field, const TArray<float>& Integration, int32 Cell);
+};
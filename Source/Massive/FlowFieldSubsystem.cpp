@@ -1,6 +1,7 @@
 #include "FlowFieldSubsystem.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "FlowFieldController.h"
 
 void UFlowFieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -12,4 +13,46 @@ void UFlowFieldSubsystem::Deinitialize()
 {
 	Super::Deinitialize();
 	UE_LOG(LogTemp, Log, TEXT("FlowFieldSubsystem Deinitialized"));
-}
\ No newline at end of file
+}
+
+void UFlowFieldSubsystem::BuildFieldsBatch(const TArray<AFlowFieldController*>& Controllers, const TArray<FVector>& TargetLocations)
+{
+	const int32 Num = FMath::Min(Controllers.Num(), TargetLocations.Num());
+
+	TMap<const AGridManager*, TSharedPtr<const FGridCostField>> SharedFields;
+	TArray<AFlowFieldController*> Building;
+	TArray<const FFlowFieldProblem*> Problems;
+	TArray<FFlowFieldSolution*> Solutions;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		AFlowFieldController* Controller = Controllers[i];
+		if (!Controller || !Controller->GridManager || Building.Contains(Controller)) continue;
+
+		TSharedPtr<const FGridCostField>& Field = SharedFields.FindOrAdd(Controller->GridManager);
+		if (!Field.IsValid())
+		{
+			Field = MakeShared<const FGridCostField>(Controller->GridManager->MakeCostField());
+		}
+
+		if (!Controller->BeginBatchBuild(TargetLocations[i], Field)) continue;
+
+		Building.Add(Controller);
+		Problems.Add(&Controller->GetBuildProblem());
+		Solutions.Add(&Controller->GetBuildSolution());
+	}
+
+	FFlowFieldSolver::SolveBatch(Problems, Solutions, BatchScratch);
+
+	SIZE_T ScratchBytes = BatchScratch.GetAllocatedSize();
+	for (const FFlowFieldScratch& WorkerScratch : BatchScratch)
+	{
+		ScratchBytes += WorkerScratch.GetAllocatedSize();
+	}
+	BatchScratchMemory.Set(ScratchBytes);
+
+	for (AFlowFieldController* Controller : Building)
+	{
+		Controller->FinishBatchBuild();
+	}
+}
@@ -2,8 +2,12 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "FlowFieldSolver.h"
+#include "MassiveStats.h"
 #include "FlowFieldSubsystem.generated.h"
 
+class AFlowFieldController;
+
 UCLASS()
 class MASSIVE_API UFlowFieldSubsystem : public UGameInstanceSubsystem
 {
@@ -12,6 +16,18 @@ class MASSIVE_API UFlowFieldSubsystem : public UGameInstanceSubsystem
 public:
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
-	
+
+	// Builds the fields of several controllers at once, e.g. for all groups ordered on the same
+	// frame. Controllers on the same grid share one copy of its costs and each field is built on
+	// its own worker. Each controller keeps its own field (AFlowFieldController::GetFlowDirection),
+	// so groups on the same grid don't overwrite each other's. TargetLocations pairs up with
+	// Controllers; extra entries on either side are ignored.
+	UFUNCTION(BlueprintCallable, Category="FlowField")
+	void BuildFieldsBatch(const TArray<AFlowFieldController*>& Controllers, const TArray<FVector>& TargetLocations);
+
+private:
+	// One per worker, kept between batches
+	TArray<FFlowFieldScratch> BatchScratch;
+	FMassiveMemoryCounter BatchScratchMemory{EMassiveMemory::FlowField};
 };
 
@@ -0,0 +1,48 @@
+#include "GridCostField.h"
+
+void FGridCostField::ComputeDistances(int32 Source, float DiagonalCost, bool bReverse, TArray<float>& OutDist) const
+{
+	struct FQueueItem
+	{
+		float Dist;
+		int32 Cell;
+		bool operator<(const FQueueItem& Other) const { return Dist < Other.Dist; }
+	};
+
+	OutDist.Init(TNumericLimits<float>::Max(), Num());
+	OutDist[Source] = 0.f;
+
+	TArray<FQueueItem> Queue;
+	Queue.Reserve(Width * 4);
+	Queue.HeapPush({ 0.f, Source });
+
+	int32 Neighbors[8];
+	bool IsDiagonal[8];
+
+	while (Queue.Num() > 0)
+	{
+		FQueueItem Item;
+		Queue.HeapPop(Item, EAllowShrinking::No);
+
+		// Lazy deletion, skip stale entries
+		if (Item.Dist > OutDist[Item.Cell]) continue;
+
+		const int32 Count = GetNeighbors(Item.Cell, Neighbors, IsDiagonal);
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Nb = Neighbors[i];
+
+			// Same cost model as the A* search: step length times the cost of the entered cell.
+			// In the reverse graph the edge Nb -> Cell enters Cell.
+			const float Step = IsDiagonal[i] ? DiagonalCost : 1.f;
+			const float Terrain = float(bReverse ? Costs[Item.Cell] : Costs[Nb]);
+			const float NewDist = Item.Dist + Step * Terrain;
+
+			if (NewDist < OutDist[Nb])
+			{
+				OutDist[Nb] = NewDist;
+				Queue.HeapPush({ NewDist, Nb });
+			}
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Flat, read-only copy of the grid's traversal costs.
+// Cheap to hand to worker threads while the game thread keeps editing AGridManager::Grid.
+// Uses the same walkability rules as AGridManager::GetNeighbors.
+struct MASSIVE_API FGridCostField
+{
+	int32 Width = 0;
+	int32 Height = 0;
+
+	// Traversal cost per cell (>= 1), or -1 if the cell can't be entered
+	TArray<int32> Costs;
+
+	// Same order as AGridManager::GetNeighbors: cardinals first, then diagonals
+	static constexpr int32 NeighborOffsets[8][2] =
+	{
+		{0, 1}, {0, -1}, {-1, 0}, {1, 0},
+		{-1, -1}, {1, -1}, {1, 1}, {-1, 1}
+	};
+
+	FORCEINLINE int32 Num() const { return Width * Height; }
+	FORCEINLINE int32 XYToIndex(int32 X, int32 Y) const { return Y * Width + X; }
+	FORCEINLINE bool IsInside(int32 X, int32 Y) const { return X >= 0 && X < Width && Y >= 0 && Y < Height; }
+	FORCEINLINE bool IsWalkable(int32 Index) const { return Costs[Index] >= 0; }
+	SIZE_T GetAllocatedSize() const { return Costs.GetAllocatedSize(); }
+
+	// Writes walkable neighbor indices into OutNeighbors, returns how many were written.
+	// Diagonals are only allowed when both adjacent cardinals are walkable (no corner cutting).
+	int32 GetNeighbors(int32 Index, int32 (&OutNeighbors)[8], bool (&OutIsDiagonal)[8]) const
+	{
+		const int32 X = Index % Width;
+		const int32 Y = Index / Width;
+		int32 Count = 0;
+
+		for (int32 i = 0; i < 8; i++)
+		{
+			const int32 NX = X + NeighborOffsets[i][0];
+			const int32 NY = Y + NeighborOffsets[i][1];
+			if (!IsInside(NX, NY)) continue;
+
+			const int32 NIdx = XYToIndex(NX, NY);
+			if (!IsWalkable(NIdx)) continue;
+
+			const bool bIsDiagonal = i >= 4;
+			if (bIsDiagonal &&
+				(!IsWalkable(XYToIndex(NX, Y)) || !IsWalkable(XYToIndex(X, NY))))
+			{
+				continue;
+			}
+
+			OutNeighbors[Count] = NIdx;
+			OutIsDiagonal[Count] = bIsDiagonal;
+			Count++;
+		}
+
+		return Count;
+	}
+
+	// Dijkstra distances from Source to every cell (-> TNumericLimits<float>::Max() if unreachable).
+	// Edges cost step length times the cost of the entered cell, like the A* search.
+	// With bReverse the distances are *to* Source instead, d(cell, Source).
+	void ComputeDistances(int32 Source, float DiagonalCost, bool bReverse, TArray<float>& OutDist) const;
+};
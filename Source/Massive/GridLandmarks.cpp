@@ -0,0 +1,249 @@
+#include "GridLandmarks.h"
+#include "MassiveStats.h"
+#include "Async/ParallelFor.h"
+
+TSharedRef<FGridLandmarks> FGridLandmarks::Build(const FGridCostField& Field, int32 NumLandmarks, float InDiagonalCost, int32 InGridVersion)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_BuildLandmarks);
+	LLM_SCOPE_BYTAG(Massive_Landmarks);
+
+	TSharedRef<FGridLandmarks> Result = MakeShared<FGridLandmarks>();
+	Result->NumCells = Field.Num();
+	Result->GridVersion = InGridVersion;
+	Result->DiagonalCost = InDiagonalCost;
+
+	if (Field.Num() == 0) return Result;
+
+	// Uniform costs mean every edge costs the same both ways
+	int32 FirstCost = -1;
+	for (const int32 Cost : Field.Costs)
+	{
+		if (Cost < 0) continue;
+		if (FirstCost == -1) FirstCost = Cost;
+		else if (Cost != FirstCost) { Result->bSymmetric = false; break; }
+	}
+
+	Result->LandmarkCells = SelectLandmarks(Field, FMath::Clamp(NumLandmarks, 1, MaxLandmarks));
+	const int32 L = Result->LandmarkCells.Num();
+	if (L == 0) return Result;
+
+	// One full Dijkstra per landmark (and direction), each on its own worker
+	const int32 NumFields = Result->bSymmetric ? L : L * 2;
+	TArray<TArray<float>> Distances;
+	Distances.SetNum(NumFields);
+
+	ParallelFor(NumFields, [&](int32 i)
+	{
+		const bool bReverse = i >= L;
+		Field.ComputeDistances(Result->LandmarkCells[i % L], InDiagonalCost, bReverse, Distances[i]);
+	});
+
+	// Per-landmark scale so the farthest reachable cell still fits below the Unreachable marker
+	Result->Scale.SetNum(L);
+	for (int32 l = 0; l < L; l++)
+	{
+		float MaxDist = 0.f;
+		for (int32 i = l; i < NumFields; i += L)
+		{
+			for (const float D : Distances[i])
+			{
+				if (D < TNumericLimits<float>::Max()) MaxDist = FMath::Max(MaxDist, D);
+			}
+		}
+		Result->Scale[l] = FMath::Max(MaxDist / float(Unreachable - 1), KINDA_SMALL_NUMBER);
+	}
+
+	// Pack into cell-major rows
+	const int32 N = Field.Num();
+	Result->FromLandmark.SetNumUninitialized(N * L);
+	if (!Result->bSymmetric)
+	{
+		Result->ToLandmark.SetNumUninitialized(N * L);
+	}
+
+	ParallelFor(N, [&](int32 Cell)
+	{
+		for (int32 l = 0; l < L; l++)
+		{
+			const float InvScale = 1.f / Result->Scale[l];
+			auto Quantize = [InvScale](float D) -> uint16
+			{
+				if (D >= TNumericLimits<float>::Max()) return Unreachable;
+				return (uint16)FMath::Min(FMath::RoundToInt(D * InvScale), int32(Unreachable - 1));
+			};
+
+			Result->FromLandmark[Cell * L + l] = Quantize(Distances[l][Cell]);
+			if (!Result->bSymmetric)
+			{
+				Result->ToLandmark[Cell * L + l] = Quantize(Distances[L + l][Cell]);
+			}
+		}
+	});
+
+	Result->Memory.Set(Result->GetAllocatedSize());
+	return Result;
+}
+
+TArray<int32> FGridLandmarks::SelectLandmarks(const FGridCostField& Field, int32 NumLandmarks)
+{
+	// Spread landmarks around the edge of the map: split the grid into angular sectors
+	// around the center and take the walkable cell farthest from the center in each.
+	// Landmarks "behind" the goal are what make ALT bounds tight.
+	const float CX = (Field.Width - 1) * 0.5f;
+	const float CY = (Field.Height - 1) * 0.5f;
+
+	TArray<int32> BestCell;
+	TArray<float> BestDistSq;
+	BestCell.Init(-1, NumLandmarks);
+	BestDistSq.Init(-1.f, NumLandmarks);
+
+	for (int32 Y = 0; Y < Field.Height; Y++)
+	{
+		for (int32 X = 0; X < Field.Width; X++)
+		{
+			const int32 Index = Field.XYToIndex(X, Y);
+			if (!Field.IsWalkable(Index)) continue;
+
+			const float DX = X - CX;
+			const float DY = Y - CY;
+			const float Angle = FMath::Atan2(DY, DX) + PI; // [0, 2PI]
+			const int32 Sector = FMath::Clamp(FMath::FloorToInt(Angle / (2.f * PI) * NumLandmarks), 0, NumLandmarks - 1);
+
+			const float DistSq = DX * DX + DY * DY;
+			if (DistSq > BestDistSq[Sector])
+			{
+				BestDistSq[Sector] = DistSq;
+				BestCell[Sector] = Index;
+			}
+		}
+	}
+
+	TArray<int32> Result;
+	for (const int32 Cell : BestCell)
+	{
+		if (Cell != -1) Result.Add(Cell);
+	}
+	return Result;
+}
+
+namespace
+{
+	// Reads a table written with BulkSerialize (element size, count, elements). Fails before
+	// allocating if the count is outside [MinNum, MaxNum] or more than the archive has left.
+	template<typename T>
+	bool LoadTable(FArchive& Ar, TArray<T>& Out, int64 MaxNum, int64 MinNum = 0)
+	{
+		int32 ElementSize = 0;
+		int32 Num = 0;
+		Ar << ElementSize << Num;
+
+		const int64 Bytes = int64(Num) * sizeof(T);
+		if (Ar.IsError() || ElementSize != sizeof(T) || Num < MinNum || Num > MaxNum || Bytes > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return false;
+		}
+
+		Out.SetNumUninitialized(Num);
+		Ar.Serialize(Out.GetData(), Bytes);
+		return !Ar.IsError();
+	}
+}
+
+void FGridLandmarks::Serialize(FArchive& Ar)
+{
+	Ar << DiagonalCost;
+	Ar << bSymmetric;
+	LandmarkCells.BulkSerialize(Ar);
+	Scale.BulkSerialize(Ar);
+	FromLandmark.BulkSerialize(Ar);
+	ToLandmark.BulkSerialize(Ar);
+}
+
+void FGridLandmarks::Save(FArchive& Ar) const
+{
+	check(Ar.IsSaving());
+	const_cast<FGridLandmarks*>(this)->Serialize(Ar);
+}
+
+TSharedPtr<FGridLandmarks> FGridLandmarks::Load(FArchive& Ar, int32 InNumCells, int32 InGridVersion)
+{
+	check(Ar.IsLoading());
+	LLM_SCOPE_BYTAG(Massive_Landmarks);
+
+	TSharedRef<FGridLandmarks> Result = MakeShared<FGridLandmarks>();
+	Result->NumCells = InNumCells;
+	Result->GridVersion = InGridVersion;
+
+	// Same layout Serialize writes, but each count is checked before its table is allocated
+	Ar << Result->DiagonalCost;
+	Ar << Result->bSymmetric;
+	if (!LoadTable(Ar, Result->LandmarkCells, MaxLandmarks)) return nullptr;
+
+	const int32 L = Result->LandmarkCells.Num();
+	const int64 TableSize = int64(InNumCells) * L;
+	if (TableSize > MAX_int32 ||
+		!LoadTable(Ar, Result->Scale, L, L) ||
+		!LoadTable(Ar, Result->FromLandmark, TableSize, TableSize) ||
+		!LoadTable(Ar, Result->ToLandmark, Result->bSymmetric ? 0 : TableSize, Result->bSymmetric ? 0 : TableSize))
+	{
+		return nullptr;
+	}
+
+	Result->Memory.Set(Result->GetAllocatedSize());
+	return Result;
+}
+
+FGridLandmarks::FGoal FGridLandmarks::MakeGoal(int32 GoalCell) const
+{
+	FGoal Goal;
+	Goal.Cell = GoalCell;
+
+	const int32 L = LandmarkCells.Num();
+	if (GoalCell < 0 || GoalCell >= NumCells) return Goal;
+
+	for (int32 l = 0; l < L; l++)
+	{
+		Goal.FromLandmark[l] = Decode(FromLandmark[GoalCell * L + l], l);
+		Goal.ToLandmark[l] = bSymmetric ? Goal.FromLandmark[l] : Decode(ToLandmark[GoalCell * L + l], l);
+	}
+	return Goal;
+}
+
+float FGridLandmarks::Heuristic(int32 Cell, const FGoal& Goal) const
+{
+	const int32 L = LandmarkCells.Num();
+	if (Goal.Cell < 0 || Cell < 0 || Cell >= NumCells) return 0.f;
+
+	const uint16* FromRow = &FromLandmark[Cell * L];
+	const uint16* ToRow = bSymmetric ? FromRow : &ToLandmark[Cell * L];
+
+	float Best = 0.f;
+	for (int32 l = 0; l < L; l++)
+	{
+		// Rounding can be off by half a step on each side, so give up one full step to stay admissible
+		const float Slack = Scale[l];
+
+		// d(L, goal) <= d(L, cell) + d(cell, goal)
+		const float FromCell = Decode(FromRow[l], l);
+		if (FromCell >= 0.f && Goal.FromLandmark[l] >= 0.f)
+		{
+			Best = FMath::Max(Best, Goal.FromLandmark[l] - FromCell - Slack);
+		}
+
+		// d(cell, L) <= d(cell, goal) + d(goal, L)
+		const float ToCell = Decode(ToRow[l], l);
+		if (ToCell >= 0.f && Goal.ToLandmark[l] >= 0.f)
+		{
+			Best = FMath::Max(Best, ToCell - Goal.ToLandmark[l] - Slack);
+		}
+	}
+
+	return Best;
+}
+
+SIZE_T FGridLandmarks::GetAllocatedSize() const
+{
+	return LandmarkCells.GetAllocatedSize() + Scale.GetAllocatedSize() +
+		FromLandmark.GetAllocatedSize() + ToLandmark.GetAllocatedSize();
+}
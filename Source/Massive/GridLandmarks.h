@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridCostField.h"
+#include "MassiveStats.h"
+
+// ALT (A*, landmarks, triangle inequality) distance tables for a grid.
+// A few landmark cells get full shortest-path distance fields; for any pair of
+// cells the triangle inequality then gives a lower bound on their distance that
+// is far tighter than octile around long walls. Immutable once built, so it can
+// be shared between threads.
+class MASSIVE_API FGridLandmarks
+{
+public:
+	static constexpr int32 MaxLandmarks = 32;
+
+	// Goal-side terms cached once per query so each heuristic call only reads the node's row
+	struct FGoal
+	{
+		int32 Cell = -1;
+		float FromLandmark[MaxLandmarks];
+		float ToLandmark[MaxLandmarks];
+	};
+
+	// Builds distance fields for NumLandmarks landmarks in parallel
+	static TSharedRef<FGridLandmarks> Build(const FGridCostField& Field, int32 NumLandmarks, float DiagonalCost, int32 GridVersion);
+
+	// Baked grids (AGridManager::SaveBakedGrid) store the tables as raw arrays. Load validates
+	// sizes against NumCells and returns null on mismatch or a truncated archive.
+	void Save(FArchive& Ar) const;
+	static TSharedPtr<FGridLandmarks> Load(FArchive& Ar, int32 NumCells, int32 GridVersion);
+
+	FGoal MakeGoal(int32 GoalCell) const;
+
+	// Admissible lower bound on the cost of going from Cell to the goal (0 if unknown)
+	float Heuristic(int32 Cell, const FGoal& Goal) const;
+
+	int32 GetNumLandmarks() const { return LandmarkCells.Num(); }
+	int32 GetNumCells() const { return NumCells; }
+	int32 GetGridVersion() const { return GridVersion; }
+	float GetDiagonalCost() const { return DiagonalCost; }
+	const TArray<int32>& GetLandmarkCells() const { return LandmarkCells; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	static constexpr uint16 Unreachable = MAX_uint16;
+
+	static TArray<int32> SelectLandmarks(const FGridCostField& Field, int32 NumLandmarks);
+
+	// Everything but NumCells and GridVersion, which belong to the grid being loaded into
+	void Serialize(FArchive& Ar);
+
+	FORCEINLINE float Decode(uint16 Q, int32 Landmark) const
+	{
+		return Q == Unreachable ? -1.f : float(Q) * Scale[Landmark];
+	}
+
+	int32 NumCells = 0;
+	int32 GridVersion = -1;
+	float DiagonalCost = 1.41421356237f;
+
+	// Costs are only direction-dependent when terrain costs differ; with uniform costs
+	// d(a, b) == d(b, a) and the "to landmark" table is skipped
+	bool bSymmetric = true;
+
+	TArray<int32> LandmarkCells;
+
+	// Quantization step per landmark, distances are stored as uint16 multiples of it
+	TArray<float> Scale;
+
+	// Cell-major so one heuristic call touches a single contiguous row:
+	// FromLandmark[Cell * NumLandmarks + L] = d(L, Cell), ToLandmark[...] = d(Cell, L)
+	TArray<uint16> FromLandmark;
+	TArray<uint16> ToLandmark;
+
+	// Released with the last reference, which may be a search still running on old landmarks
+	FMassiveMemoryCounter Memory{EMassiveMemory::Landmarks};
+};
@@ -1,9 +1,95 @@
 #include "GridManager.h"
+#include "MassiveStats.h"
 #include "DrawDebugHelpers.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Memory/MemoryView.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Engine/World.h"
+#include "Engine/OverlapResult.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Pawn.h"
+#include "TimerManager.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+namespace
+{
+    // Baked grid files: header, then costs, blocked bitmap, clearance and optional landmarks as
+    // raw arrays. Bump the version whenever the layout changes, older files are then rejected.
+    constexpr uint32 BakedGridMagic = 0x4D475244; // "MGRD"
+    constexpr int32 BakedGridVersion = 1;
+
+    FString ResolveBakedGridPath(const FString& FilePath)
+    {
+        return FPaths::IsRelative(FilePath) ? FPaths::Combine(FPaths::ProjectDir(), FilePath) : FilePath;
+    }
+
+    // Sections are written with BulkSerialize: element size, count, then the elements. Returns the
+    // count and a pointer to the elements inside Data, or INDEX_NONE if the element size is wrong,
+    // the count is above MaxNum or the elements run past the end of the file.
+    int32 ReadBakedSection(FMemoryReaderView& Reader, FMemoryView Data, int32 ElementSize, int32 MaxNum, const uint8*& OutElements)
+    {
+        int32 SerializedElementSize = 0;
+        int32 Num = 0;
+        Reader << SerializedElementSize << Num;
+
+        const int64 Offset = Reader.Tell();
+        const int64 Bytes = int64(Num) * ElementSize;
+        if (Reader.IsError() || SerializedElementSize != ElementSize || Num < 0 || Num > MaxNum ||
+            Offset + Bytes > int64(Data.GetSize()))
+        {
+            Reader.SetError();
+            return INDEX_NONE;
+        }
+
+        OutElements = static_cast<const uint8*>(Data.GetData()) + Offset;
+        Reader.Seek(Offset + Bytes);
+        return Num;
+    }
+
+    // Runs Func(y) for every row, rows grouped into blocks of roughly MinCellsPerBlock cells so
+    // each task does enough work to be worth scheduling
+    template<typename FuncType>
+    void ParallelForRows(int32 Width, int32 Height, FuncType&& Func)
+    {
+        constexpr int32 MinCellsPerBlock = 16 * 1024;
+        const int32 RowsPerBlock = FMath::Max(1, MinCellsPerBlock / FMath::Max(1, Width));
+        const int32 NumBlocks = FMath::DivideAndRoundUp(Height, RowsPerBlock);
+
+        ParallelFor(NumBlocks, [&](int32 Block)
+        {
+            const int32 EndRow = FMath::Min(Height, (Block + 1) * RowsPerBlock);
+            for (int32 y = Block * RowsPerBlock; y < EndRow; y++)
+            {
+                Func(y);
+            }
+        });
+    }
+
+    // Units stand on the grid, they aren't part of it
+    UPrimitiveComponent* GetBakeableComponent(const FOverlapResult& Overlap)
+    {
+        UPrimitiveComponent* Component = Overlap.GetComponent();
+        return Component && !Cast<APawn>(Overlap.GetActor()) ? Component : nullptr;
+    }
+}
 
 AGridManager::AGridManager()
 {
     PrimaryActorTick.bCanEverTick = false;
+
+    RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+    // Purely visual, the grid already is the obstacle
+    ObstacleInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("ObstacleInstances"));
+    ObstacleInstances->SetupAttachment(RootComponent);
+    ObstacleInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
 void AGridManager::BeginPlay()
@@ -11,36 +97,554 @@ void AGridManager::BeginPlay()
     Super::BeginPlay();
 }
 
+void AGridManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UntrackCollisionObstacles();
+    Super::EndPlay(EndPlayReason);
+}
+
+void AGridManager::Destroyed()
+{
+    // Editor bakes track obstacles too, and EndPlay never runs there
+    UntrackCollisionObstacles();
+    Super::Destroyed();
+}
+
 void AGridManager::GenerateGrid()
 {
-    //UE_LOG(LogTemp, Warning, TEXT("Generating Grid"));
-    Grid.Empty();
-    Grid.SetNum(GridWidth * GridHeight);
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_GenerateGrid);
+    LLM_SCOPE_BYTAG(Massive_Grid);
 
-    const float OffsetX = (GridWidth * CellSize) * 0.5f - CellSize * 0.5f;
-    const float OffsetY = (GridHeight * CellSize) * 0.5f - CellSize * 0.5f;
+    // A baked grid replaces generation entirely
+    if (bUseBakedGrid && LoadBakedGrid(BakedGridPath)) return;
+
+    ResetRandomStream();
 
-    for (int32 y = 0; y < GridHeight; y++)
+    //UE_LOG(LogTemp, Warning, TEXT("Generating Grid"));
+    const int32 Num = GridWidth * GridHeight;
+    Grid.Empty(Num);
+    Grid.SetNumUninitialized(Num);
+
+    // World positions aren't stored, CellToWorld derives them from X/Y when needed
+    ParallelForRows(GridWidth, GridHeight, [this](int32 y)
     {
         for (int32 x = 0; x < GridWidth; x++)
         {
-            const int32 Index = XYToIndex(x, y);
+            FGridCell& Cell = *new (&Grid[XYToIndex(x, y)]) FGridCell();
+            Cell.X = x;
+            Cell.Y = y;
+        }
+    });
+
+    // RandomizeGridCosts notifies on its own
+    if (bSpawnObstacles) RandomizeGridCosts(ObstacleSpawnChance);
+    else NotifyGridChanged();
+
+    if (bDrawDebug) DrawDebugGrid();
+}
 
-            FGridCell& Cell = Grid[Index];
+bool AGridManager::ImportMovingAIMap(const FString& FilePath)
+{
+    TArray<FString> Lines;
+    if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("ImportMovingAIMap: could not read %s"), *FilePath);
+        return false;
+    }
+
+    // Header: type / height / width, then "map" and one line per row
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 FirstRow = INDEX_NONE;
+    for (int32 i = 0; i < Lines.Num(); i++)
+    {
+        FString Key, Value;
+        if (!Lines[i].TrimStartAndEnd().Split(TEXT(" "), &Key, &Value))
+        {
+            if (Lines[i].TrimStartAndEnd() == TEXT("map"))
+            {
+                FirstRow = i + 1;
+                break;
+            }
+            continue;
+        }
+
+        if (Key == TEXT("width")) Width = FCString::Atoi(*Value);
+        else if (Key == TEXT("height")) Height = FCString::Atoi(*Value);
+    }
+
+    if (Width <= 0 || Height <= 0 || FirstRow == INDEX_NONE || Lines.Num() - FirstRow < Height)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ImportMovingAIMap: %s is not a valid map file"), *FilePath);
+        return false;
+    }
+
+    GridWidth = Width;
+    GridHeight = Height;
+
+    // Cells are built straight from the map, the random obstacles and baked grid don't apply
+    LLM_SCOPE_BYTAG(Massive_Grid);
+    Grid.Empty(Width * Height);
+    Grid.SetNumUninitialized(Width * Height);
+
+    ParallelForRows(Width, Height, [&](int32 y)
+    {
+        const FString& Row = Lines[FirstRow + y];
+        for (int32 x = 0; x < Width; x++)
+        {
+            const TCHAR Terrain = x < Row.Len() ? Row[x] : TEXT('@');
+            const bool bWalkable = Terrain == TEXT('.') || Terrain == TEXT('G') || Terrain == TEXT('S');
+
+            FGridCell& Cell = *new (&Grid[XYToIndex(x, y)]) FGridCell();
             Cell.X = x;
             Cell.Y = y;
+            Cell.Cost = bWalkable ? 1 : -1;
+            Cell.bIsBlocked = !bWalkable;
+        }
+    });
+
+    NotifyGridChanged();
+
+    if (bDrawDebug) DrawDebugGrid();
+
+    UE_LOG(LogTemp, Log, TEXT("ImportMovingAIMap: loaded %s (%dx%d)"), *FilePath, Width, Height);
+    return true;
+}
+
+bool AGridManager::SaveBakedGrid(const FString& FilePath)
+{
+    const int32 Num = GridWidth * GridHeight;
+    if (Num == 0 || Grid.Num() != Num)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("SaveBakedGrid: no grid to bake"));
+        return false;
+    }
+
+    TArray<int32> Costs;
+    TArray<uint8> Blocked;
+    Costs.SetNumUninitialized(Num);
+    Blocked.SetNumZeroed(FMath::DivideAndRoundUp(Num, 8));
+    for (int32 i = 0; i < Num; i++)
+    {
+        Costs[i] = Grid[i].Cost;
+        if (Grid[i].bIsBlocked) Blocked[i >> 3] |= uint8(1 << (i & 7));
+    }
+
+    // A background build may still be running, the bake shouldn't depend on its timing
+    TSharedPtr<const FGridLandmarks> BakedLandmarks = GetLandmarks();
+    if (!BakedLandmarks.IsValid() && bBuildLandmarks)
+    {
+        BakedLandmarks = FGridLandmarks::Build(MakeCostField(), NumLandmarks, LandmarkDiagonalCost, GridVersion);
+    }
+
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+
+    uint32 Magic = BakedGridMagic;
+    int32 Version = BakedGridVersion;
+    int32 Width = GridWidth;
+    int32 Height = GridHeight;
+    int32 BakedMaxClearance = MaxClearance;
+    Writer << Magic << Version << Width << Height << BakedMaxClearance;
+
+    Costs.BulkSerialize(Writer);
+    Blocked.BulkSerialize(Writer);
+    Clearance.BulkSerialize(Writer);
+
+    bool bHasLandmarks = BakedLandmarks.IsValid() && BakedLandmarks->GetNumLandmarks() > 0;
+    Writer << bHasLandmarks;
+    if (bHasLandmarks) BakedLandmarks->Save(Writer);
+
+    const FString Path = ResolveBakedGridPath(FilePath);
+    if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+    {
+        UE_LOG(LogTemp, Error, TEXT("SaveBakedGrid: could not write %s"), *Path);
+        return false;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("SaveBakedGrid: wrote %s (%dx%d, %.1f KB)"), *Path, Width, Height, Bytes.Num() / 1024.f);
+    return true;
+}
+
+bool AGridManager::LoadBakedGrid(const FString& FilePath)
+{
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_LoadBakedGrid);
+    LLM_SCOPE_BYTAG(Massive_Grid);
+
+    const FString Path = ResolveBakedGridPath(FilePath);
+
+    // Mapped where the platform supports it, otherwise read in one go. The region has to go before the handle.
+    TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+    TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion(0, MappedFile->GetFileSize()) : nullptr);
+
+    TArray<uint8> FileBytes;
+    FMemoryView Data;
+    if (MappedRegion)
+    {
+        Data = MakeMemoryView(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+    }
+    else if (FFileHelper::LoadFileToArray(FileBytes, *Path, FILEREAD_Silent))
+    {
+        Data = MakeMemoryView(FileBytes);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Warning, TEXT("LoadBakedGrid: could not open %s"), *Path);
+        return false;
+    }
+
+    FMemoryReaderView Reader(Data);
+
+    uint32 Magic = 0;
+    int32 Version = 0;
+    int32 Width = 0;
+    int32 Height = 0;
+    int32 BakedMaxClearance = 0;
+    Reader << Magic << Version << Width << Height << BakedMaxClearance;
+
+    if (Reader.IsError() || Magic != BakedGridMagic || Version != BakedGridVersion || Width <= 0 || Height <= 0 ||
+        int64(Width) * Height > MAX_int32)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("LoadBakedGrid: %s is not a version %d baked grid"), *Path, BakedGridVersion);
+        return false;
+    }
+
+    const int32 Num = Width * Height;
+
+    // Every count is checked against the header and the file size before anything is allocated
+    const uint8* Costs = nullptr;
+    const uint8* Blocked = nullptr;
+    const uint8* BakedClearance = nullptr;
+    const int32 NumBlockedBytes = FMath::DivideAndRoundUp(Num, 8);
+    const bool bSectionsValid =
+        ReadBakedSection(Reader, Data, sizeof(int32), Num, Costs) == Num &&
+        ReadBakedSection(Reader, Data, sizeof(uint8), NumBlockedBytes, Blocked) == NumBlockedBytes;
+    const int32 NumBakedClearance = bSectionsValid ? ReadBakedSection(Reader, Data, sizeof(uint8), Num, BakedClearance) : INDEX_NONE;
+
+    // Landmarks are read before the grid is touched, so a bad file leaves everything as it was
+    const int32 NewGridVersion = GridVersion + 1;
+    bool bHasLandmarks = false;
+    if (NumBakedClearance != INDEX_NONE) Reader << bHasLandmarks;
+    TSharedPtr<const FGridLandmarks> BakedLandmarks = bHasLandmarks ? FGridLandmarks::Load(Reader, Num, NewGridVersion) : nullptr;
+
+    if (!bSectionsValid || NumBakedClearance == INDEX_NONE || Reader.IsError() || (bHasLandmarks && !BakedLandmarks.IsValid()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("LoadBakedGrid: %s is truncated or inconsistent"), *Path);
+        return false;
+    }
+
+    GridWidth = Width;
+    GridHeight = Height;
+    Grid.Empty(Num);
+    Grid.SetNumUninitialized(Num);
+
+    // Cells are built straight from the file, the sections are never copied out first
+    ParallelForRows(Width, Height, [&](int32 y)
+    {
+        for (int32 x = 0; x < Width; x++)
+        {
+            const int32 Index = XYToIndex(x, y);
+            FGridCell& Cell = *new (&Grid[Index]) FGridCell();
+            Cell.X = x;
+            Cell.Y = y;
+            Cell.Cost = FPlatformMemory::ReadUnaligned<int32>(Costs + Index * sizeof(int32));
+            Cell.bIsBlocked = (Blocked[Index >> 3] >> (Index & 7)) & 1;
+        }
+    });
+
+    // Clearance is capped at MaxClearance, so a bake made with another cap is recomputed
+    if (NumBakedClearance == Num && BakedMaxClearance == MaxClearance)
+    {
+        Clearance.SetNumUninitialized(Num);
+        FMemory::Memcpy(Clearance.GetData(), BakedClearance, Num);
+    }
+    else
+    {
+        RebuildClearance();
+    }
+
+    // What InvalidateDerivedData does, minus rebuilding the landmarks that just came with the file
+    GridVersion = NewGridVersion;
+    Landmarks = BakedLandmarks;
+    if (!Landmarks.IsValid() && bBuildLandmarks) RebuildLandmarks();
+
+    // Every cell may have changed; the size check in there rebuilds the instances if the grid was resized
+    DirtyObstacleAreas.Reset();
+    DirtyObstacleAreas.Add(FIntRect(0, 0, Width - 1, Height - 1));
+    SyncObstacleInstances();
+    UpdateMemoryStats();
+
+    if (bDrawDebug) DrawDebugGrid();
+
+    UE_LOG(LogTemp, Log, TEXT("LoadBakedGrid: loaded %s (%dx%d%s)"), *Path, Width, Height,
+        MappedRegion ? TEXT(", mapped") : TEXT(""));
+    return true;
+}
+
+void AGridManager::BakeGrid()
+{
+    SaveBakedGrid(BakedGridPath);
+}
+
+void AGridManager::BakeCollision()
+{
+    if (Grid.Num() == 0 || Grid.Num() != GridWidth * GridHeight)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("BakeCollision: no grid to bake into, generate it first"));
+        return;
+    }
+
+    // The full bake finds every obstacle again, so obstacles that are gone stop being watched
+    UntrackCollisionObstacles();
+    IssueCollisionBake(FIntPoint(0, 0), FIntPoint(GridWidth - 1, GridHeight - 1));
+}
+
+void AGridManager::RebakeCollision(const FBox& WorldArea)
+{
+    if (!WorldArea.IsValid || Grid.Num() == 0 || Grid.Num() != GridWidth * GridHeight) return;
+
+    const FVector HalfCell(CellSize * 0.5f, CellSize * 0.5f, 0.f);
+    const FBox GridBounds(CellToWorld(FIntPoint(0, 0)) - HalfCell, CellToWorld(FIntPoint(GridWidth - 1, GridHeight - 1)) + HalfCell);
+    if (!WorldArea.IntersectXY(GridBounds)) return;
+
+    // WorldToCell clamps, so an area partly off the grid rebakes the part on it
+    IssueCollisionBake(WorldToCell(WorldArea.Min), WorldToCell(WorldArea.Max));
+}
+
+void AGridManager::IssueCollisionBake(const FIntPoint& MinCell, const FIntPoint& MaxCell)
+{
+    UWorld* World = GetWorld();
+    if (!World) return;
+
+    // Snap to whole blocks so a rebake queries the same boxes the full bake did
+    const int32 BlockSize = FMath::Max(1, CollisionBakeBlockSize);
+    const FIntPoint MinBlock(MinCell.X / BlockSize, MinCell.Y / BlockSize);
+    const FIntPoint MaxBlock(MaxCell.X / BlockSize, MaxCell.Y / BlockSize);
+
+    TArray<FCollisionBakeBlock> Blocks;
+    Blocks.Reserve((MaxBlock.X - MinBlock.X + 1) * (MaxBlock.Y - MinBlock.Y + 1));
+    for (int32 by = MinBlock.Y; by <= MaxBlock.Y; by++)
+    {
+        for (int32 bx = MinBlock.X; bx <= MaxBlock.X; bx++)
+        {
+            FCollisionBakeBlock& Block = Blocks.AddDefaulted_GetRef();
+            Block.Cells.Min = FIntPoint(bx * BlockSize, by * BlockSize);
+            Block.Cells.Max = FIntPoint(FMath::Min(GridWidth, (bx + 1) * BlockSize) - 1, FMath::Min(GridHeight, (by + 1) * BlockSize) - 1);
+            Block.GridSize = FIntPoint(GridWidth, GridHeight);
+        }
+    }
+
+    const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MassiveCollisionBake), false, this);
+
+    if (World->IsGameWorld())
+    {
+        if (!CollisionOverlapDelegate.IsBound())
+        {
+            CollisionOverlapDelegate.BindUObject(this, &AGridManager::OnCollisionOverlap);
+        }
+
+        // The async trace runs these on worker threads and calls back on the game thread next frame
+        for (const FCollisionBakeBlock& Block : Blocks)
+        {
+            FVector Center;
+            const FCollisionShape Shape = MakeCollisionBlockShape(Block.Cells, Center);
+            const uint32 BlockId = NextCollisionBlockId++;
+            PendingCollisionBlocks.Add(BlockId, Block);
+            World->AsyncOverlapByChannel(Center, FQuat::Identity, CollisionBakeChannel, Shape, QueryParams,
+                FCollisionResponseParams::DefaultResponseParam, &CollisionOverlapDelegate, BlockId);
+        }
+        return;
+    }
+
+    // Nothing ticks the world to deliver async results here, so run the same queries right away.
+    // Classifying tests components directly, which is only safe on the game thread.
+    TArray<FOverlapResult> Overlaps;
+    for (const FCollisionBakeBlock& Block : Blocks)
+    {
+        FVector Center;
+        const FCollisionShape Shape = MakeCollisionBlockShape(Block.Cells, Center);
+        Overlaps.Reset();
+        World->OverlapMultiByChannel(Overlaps, Center, FQuat::Identity, CollisionBakeChannel, Shape, QueryParams);
+        ClassifyCollisionBlock(Block, Overlaps);
+        TrackCollisionObstacles(Overlaps);
+    }
+
+    NotifyCellsChanged();
+}
+
+void AGridManager::OnCollisionOverlap(const FTraceHandle& Handle, FOverlapDatum& Datum)
+{
+    FCollisionBakeBlock Block;
+    if (!PendingCollisionBlocks.RemoveAndCopyValue(Datum.UserData, Block)) return;
 
-            FVector WorldPos = GridOrigin +
-                FVector(x * CellSize - OffsetX, y * CellSize - OffsetY, 0);
+    // Results for a grid that has since been resized or replaced are dropped
+    if (Block.GridSize == FIntPoint(GridWidth, GridHeight) && Grid.Num() == GridWidth * GridHeight)
+    {
+        ClassifyCollisionBlock(Block, Datum.OutOverlaps);
+        TrackCollisionObstacles(Datum.OutOverlaps);
+    }
+
+    if (PendingCollisionBlocks.Num() == 0) NotifyCellsChanged();
+}
+
+FCollisionShape AGridManager::MakeCollisionBlockShape(const FIntRect& Cells, FVector& OutCenter) const
+{
+    const FVector MinCenter = CellToWorld(Cells.Min);
+    const FVector MaxCenter = CellToWorld(Cells.Max);
+
+    OutCenter = (MinCenter + MaxCenter) * 0.5f + FVector(0, 0, CollisionBakeHeight * 0.5f);
+    return FCollisionShape::MakeBox(FVector(
+        (MaxCenter.X - MinCenter.X + CellSize) * 0.5f,
+        (MaxCenter.Y - MinCenter.Y + CellSize) * 0.5f,
+        CollisionBakeHeight * 0.5f));
+}
+
+void AGridManager::ClassifyCollisionBlock(const FCollisionBakeBlock& Block, const TArray<FOverlapResult>& Overlaps)
+{
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_CollisionBake);
+
+    const FIntRect& Cells = Block.Cells;
+    DirtyObstacleAreas.Add(Cells);
 
-            Cell.WorldLocation = WorldPos;
+    for (int32 y = Cells.Min.Y; y <= Cells.Max.Y; y++)
+    {
+        for (int32 x = Cells.Min.X; x <= Cells.Max.X; x++)
+        {
+            FGridCell& Cell = Grid[XYToIndex(x, y)];
             Cell.Cost = 1;
             Cell.bIsBlocked = false;
         }
     }
 
-    if (bSpawnObstacles) RandomizeGridCosts(ObstacleSpawnChance);
-    if (bDrawDebug) DrawDebugGrid();
+    const float HalfCell = FMath::Max(1.f, CellSize * 0.5f - CollisionCellInset);
+    const FCollisionShape CellShape = FCollisionShape::MakeBox(FVector(HalfCell, HalfCell, CollisionBakeHeight * 0.5f));
+
+    for (const FOverlapResult& Overlap : Overlaps)
+    {
+        UPrimitiveComponent* Component = GetBakeableComponent(Overlap);
+        if (!Component) continue;
+
+        const bool bBlocking = Overlap.bBlockingHit;
+        if (!bBlocking && CollisionOverlapCost <= 0) continue;
+
+        // The block query only says the component is somewhere in the block; test the cells
+        // under its bounds against its actual collision
+        const FBox Bounds = Component->Bounds.GetBox();
+        const FIntPoint BoundsMin = WorldToCell(Bounds.Min);
+        const FIntPoint BoundsMax = WorldToCell(Bounds.Max);
+
+        for (int32 y = FMath::Max(Cells.Min.Y, BoundsMin.Y); y <= FMath::Min(Cells.Max.Y, BoundsMax.Y); y++)
+        {
+            for (int32 x = FMath::Max(Cells.Min.X, BoundsMin.X); x <= FMath::Min(Cells.Max.X, BoundsMax.X); x++)
+            {
+                FGridCell& Cell = Grid[XYToIndex(x, y)];
+                if (Cell.bIsBlocked || (!bBlocking && Cell.Cost >= CollisionOverlapCost)) continue;
+
+                const FVector Center = CellToWorld(FIntPoint(x, y)) + FVector(0, 0, CollisionBakeHeight * 0.5f);
+                if (!Component->OverlapComponent(Center, FQuat::Identity, CellShape)) continue;
+
+                if (bBlocking)
+                {
+                    Cell.Cost = -1;
+                    Cell.bIsBlocked = true;
+                }
+                else
+                {
+                    Cell.Cost = CollisionOverlapCost;
+                }
+            }
+        }
+    }
+}
+
+void AGridManager::TrackCollisionObstacles(const TArray<FOverlapResult>& Overlaps)
+{
+    if (!bRebakeMovedObstacles) return;
+
+    // Destroyed components took their binding with them, only the entry is left
+    for (auto It = TrackedObstacles.CreateIterator(); It; ++It)
+    {
+        if (!It->Key.IsValid()) It.RemoveCurrent();
+    }
+
+    for (const FOverlapResult& Overlap : Overlaps)
+    {
+        UPrimitiveComponent* Component = GetBakeableComponent(Overlap);
+        if (!Component || Component->Mobility != EComponentMobility::Movable) continue;
+
+        if (FBox* LastBounds = TrackedObstacles.Find(Component))
+        {
+            *LastBounds = Component->Bounds.GetBox();
+            continue;
+        }
+
+        TrackedObstacles.Add(Component, Component->Bounds.GetBox());
+        Component->TransformUpdated.AddUObject(this, &AGridManager::OnObstacleMoved);
+    }
+}
+
+void AGridManager::UntrackCollisionObstacles()
+{
+    for (const TPair<TWeakObjectPtr<USceneComponent>, FBox>& Tracked : TrackedObstacles)
+    {
+        if (USceneComponent* Component = Tracked.Key.Get())
+        {
+            Component->TransformUpdated.RemoveAll(this);
+        }
+    }
+    TrackedObstacles.Empty();
+    PendingRebakeArea = FBox(ForceInit);
+}
+
+void AGridManager::OnObstacleMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport)
+{
+    FBox* LastBounds = TrackedObstacles.Find(Component);
+    if (!LastBounds || !bRebakeMovedObstacles) return;
+
+    // Both the cells it left and the ones it now covers change. Everything that moves this
+    // frame goes into one rebake.
+    const FBox NewBounds = Component->Bounds.GetBox();
+    PendingRebakeArea += *LastBounds;
+    PendingRebakeArea += NewBounds;
+    *LastBounds = NewBounds;
+
+    ScheduleGridFlush();
+}
+
+void AGridManager::ScheduleGridFlush()
+{
+    if (bGridFlushScheduled) return;
+
+    UWorld* World = GetWorld();
+    if (World && World->IsGameWorld())
+    {
+        bGridFlushScheduled = true;
+        World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &AGridManager::FlushPendingGridChanges));
+    }
+    else
+    {
+        // Nothing ticks the timer here
+        FlushPendingGridChanges();
+    }
+}
+
+void AGridManager::FlushPendingGridChanges()
+{
+    bGridFlushScheduled = false;
+
+    if (PendingRebakeArea.IsValid)
+    {
+        const FBox Area = PendingRebakeArea;
+        PendingRebakeArea = FBox(ForceInit);
+        RebakeCollision(Area);
+    }
+
+    // A rebake above may have rebuilt them already
+    if (bLandmarkRebuildDeferred)
+    {
+        bLandmarkRebuildDeferred = false;
+        if (bBuildLandmarks && !GetLandmarks().IsValid()) RebuildLandmarks();
+    }
 }
 
 void AGridManager::DrawDebugGrid()
@@ -51,6 +655,8 @@ void AGridManager::DrawDebugGrid()
 
     for (const FGridCell& Cell : Grid)
     {
+        const FVector CellWorld = CellToWorld(FIntPoint(Cell.X, Cell.Y));
+
         // Color based on blocked/unblocked for Theta* visualization
         const FColor CellColor = Cell.bIsBlocked || Cell.Cost < 0 ? FColor::Red : FColor::White;
 
@@ -60,7 +666,7 @@ void AGridManager::DrawDebugGrid()
         // Draw the cell box
         DrawDebugBox(
             GetWorld(),
-            Cell.WorldLocation,
+            CellWorld,
             FVector(CellSize * 0.5f, CellSize * 0.5f, 5.f),
             CellColor,
             true,   // persistent
@@ -77,7 +683,7 @@ void AGridManager::DrawDebugGrid()
         // Draw integration and cost values
         DrawDebugString(
             GetWorld(),
-            Cell.WorldLocation + FVector(0.f, CellSize * 0.5f, 5.f),
+            CellWorld + FVector(0.f, CellSize * 0.5f, 5.f),
             ToPrint,
             nullptr,
             FColor::White,
@@ -91,8 +697,8 @@ void AGridManager::DrawDebugGrid()
             // Draw FlowField directional arrow
             DrawDebugDirectionalArrow(
                 GetWorld(),
-                Cell.WorldLocation,
-                Cell.WorldLocation + Cell.FlowDirection * 30.f,
+                CellWorld,
+                CellWorld + Cell.FlowDirection * 30.f,
                 10.f,
                 FColor::Yellow,
                 true,
@@ -123,26 +729,64 @@ void AGridManager::RandomizeGridCosts(float Chance)
     const int32 MaxX = CenterX + HalfIgnore - 1;
     const int32 MinY = CenterY - HalfIgnore;
     const int32 MaxY = CenterY + HalfIgnore - 1;
-    
-    for (FGridCell& Cell : Grid)
+
+    // One stream per row, derived from the grid's stream, so the layout only depends on the
+    // seed and not on how rows end up split across threads
+    const int32 BaseSeed = RandomStream.RandHelper(MAX_int32);
+
+    ParallelForRows(GridWidth, GridHeight, [&](int32 y)
     {
-        if (Cell.X >= MinX && Cell.X <= MaxX &&
-            Cell.Y >= MinY && Cell.Y <= MaxY)
-        {
-            continue;
-        }
-        
-        if (FMath::FRand() < Chance)
-        {
-            Cell.Cost = -1;
-            Cell.bIsBlocked = true;
-        }
-        else
+        FRandomStream RowStream(HashCombine(GetTypeHash(BaseSeed), GetTypeHash(y)));
+
+        for (int32 x = 0; x < GridWidth; x++)
         {
-            Cell.Cost = 1;
-            Cell.bIsBlocked = false;
+            // Drawn for skipped cells too, so the spawn area doesn't shift the rest of the row
+            const float Roll = RowStream.FRand();
+            if (x >= MinX && x <= MaxX && y >= MinY && y <= MaxY) continue;
+
+            FGridCell& Cell = Grid[XYToIndex(x, y)];
+            if (Roll < Chance)
+            {
+                Cell.Cost = -1;
+                Cell.bIsBlocked = true;
+            }
+            else
+            {
+                Cell.Cost = 1;
+                Cell.bIsBlocked = false;
+            }
         }
+    });
+
+    NotifyGridChanged();
+}
+
+void AGridManager::ResetRandomStream()
+{
+    int32 Seed = RandomSeed;
+    if (Seed == 0)
+    {
+        Seed = FMath::Max(1, FMath::Rand());
+        UE_LOG(LogTemp, Log, TEXT("GridManager: RandomSeed is 0, generating with seed %d"), Seed);
+    }
+    RandomStream.Initialize(Seed);
+}
+
+int32 AGridManager::ComputeChecksum() const
+{
+    uint32 Crc = FCrc::MemCrc32(&GridWidth, sizeof(GridWidth));
+    Crc = FCrc::MemCrc32(&GridHeight, sizeof(GridHeight), Crc);
+
+    for (const FGridCell& Cell : Grid)
+    {
+        const uint8 bBlocked = Cell.bIsBlocked ? 1 : 0;
+        Crc = FCrc::MemCrc32(&Cell.Cost, sizeof(Cell.Cost), Crc);
+        Crc = FCrc::MemCrc32(&bBlocked, sizeof(bBlocked), Crc);
+        Crc = FCrc::MemCrc32(&Cell.IntegrationValue, sizeof(Cell.IntegrationValue), Crc);
+        Crc = FCrc::MemCrc32(&Cell.FlowDirection, sizeof(Cell.FlowDirection), Crc);
     }
+
+    return (int32)Crc;
 }
 
 void AGridManager::SpawnObstacles(TSubclassOf<AActor> ObstacleClass)
@@ -153,6 +797,18 @@ void AGridManager::SpawnObstacles(TSubclassOf<AActor> ObstacleClass)
         return;
     }
 
+    if (bInstancedObstacles)
+    {
+        if (!ObstacleMesh || !ObstacleInstances)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("SpawnObstacles: instanced obstacles need an ObstacleMesh"));
+            return;
+        }
+
+        RebuildObstacleInstances();
+        return;
+    }
+
     UWorld* World = GetWorld();
     if (!World)
     {
@@ -167,11 +823,12 @@ void AGridManager::SpawnObstacles(TSubclassOf<AActor> ObstacleClass)
             FActorSpawnParameters Params;
             Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-            AActor* SpawnedObstacle = World->SpawnActor<AActor>(ObstacleClass, Cell.WorldLocation, FRotator::ZeroRotator, Params);
+            const FVector CellWorld = CellToWorld(FIntPoint(Cell.X, Cell.Y));
+            AActor* SpawnedObstacle = World->SpawnActor<AActor>(ObstacleClass, CellWorld, FRotator::ZeroRotator, Params);
             if (!SpawnedObstacle)
             {
                 UE_LOG(LogTemp, Warning, TEXT("Failed to spawn obstacle at (%f, %f, %f)"),
-                    Cell.WorldLocation.X, Cell.WorldLocation.Y, Cell.WorldLocation.Z);
+                    CellWorld.X, CellWorld.Y, CellWorld.Z);
             }
         }
     }
@@ -179,6 +836,114 @@ void AGridManager::SpawnObstacles(TSubclassOf<AActor> ObstacleClass)
     UE_LOG(LogTemp, Log, TEXT("Obstacles spawned for blocked cells."));
 }
 
+void AGridManager::ClearObstacleInstances()
+{
+    if (ObstacleInstances) ObstacleInstances->ClearInstances();
+
+    CellObstacleInstance.Empty();
+    FreeObstacleInstances.Empty();
+    UpdateMemoryStats();
+}
+
+void AGridManager::RebuildObstacleInstances()
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    ObstacleInstances->SetStaticMesh(ObstacleMesh);
+    ObstacleInstances->ClearInstances();
+    FreeObstacleInstances.Empty();
+    DirtyObstacleAreas.Reset();
+
+    TArray<FTransform> Transforms;
+    CellObstacleInstance.Init(INDEX_NONE, Grid.Num());
+    for (int32 i = 0; i < Grid.Num(); i++)
+    {
+        if (!Grid[i].bIsBlocked) continue;
+
+        CellObstacleInstance[i] = Transforms.Num();
+        Transforms.Add(MakeObstacleTransform(i));
+    }
+
+    // One batch, so the HISM tree and render state are built once rather than per instance
+    ObstacleInstances->AddInstances(Transforms, false, true);
+    UpdateMemoryStats();
+
+    UE_LOG(LogTemp, Log, TEXT("Obstacles instanced for %d blocked cells in %.2f ms."),
+        Transforms.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void AGridManager::SyncObstacleInstances()
+{
+    if (CellObstacleInstance.Num() == 0 || !ObstacleInstances)
+    {
+        DirtyObstacleAreas.Reset();
+        return;
+    }
+
+    // Resized or replaced grid, nothing to reuse
+    if (CellObstacleInstance.Num() != Grid.Num())
+    {
+        RebuildObstacleInstances();
+        return;
+    }
+
+    bool bChanged = false;
+    for (const FIntRect& Area : DirtyObstacleAreas)
+    {
+        for (int32 y = FMath::Max(0, Area.Min.Y); y <= FMath::Min(GridHeight - 1, Area.Max.Y); y++)
+        {
+            for (int32 x = FMath::Max(0, Area.Min.X); x <= FMath::Min(GridWidth - 1, Area.Max.X); x++)
+            {
+                bChanged |= UpdateObstacleInstance(XYToIndex(x, y));
+            }
+        }
+    }
+    DirtyObstacleAreas.Reset();
+
+    if (!bChanged) return;
+
+    // Mostly hidden instances after a big change; rebuilding packs them again
+    if (FreeObstacleInstances.Num() > ObstacleInstances->GetInstanceCount() / 2)
+    {
+        RebuildObstacleInstances();
+        return;
+    }
+
+    ObstacleInstances->MarkRenderStateDirty();
+    UpdateMemoryStats();
+}
+
+bool AGridManager::UpdateObstacleInstance(int32 Index)
+{
+    int32& Instance = CellObstacleInstance[Index];
+    const bool bBlocked = Grid[Index].bIsBlocked;
+    if (bBlocked == (Instance != INDEX_NONE)) return false;
+
+    if (!bBlocked)
+    {
+        ObstacleInstances->UpdateInstanceTransform(Instance, FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), true, false);
+        FreeObstacleInstances.Add(Instance);
+        Instance = INDEX_NONE;
+        return true;
+    }
+
+    if (FreeObstacleInstances.Num() > 0)
+    {
+        Instance = FreeObstacleInstances.Pop(EAllowShrinking::No);
+        ObstacleInstances->UpdateInstanceTransform(Instance, MakeObstacleTransform(Index), true, false);
+    }
+    else
+    {
+        Instance = ObstacleInstances->AddInstance(MakeObstacleTransform(Index), true);
+    }
+    return true;
+}
+
+FTransform AGridManager::MakeObstacleTransform(int32 Index) const
+{
+    return FTransform(FQuat::Identity, CellToWorld(FIntPoint(Grid[Index].X, Grid[Index].Y)), ObstacleMeshScale);
+}
+
 void AGridManager::DiagonalGridCosts()
 {
     const int32 HalfIgnore = IgnoreSpawnDimension * 0.5;
@@ -194,50 +959,52 @@ void AGridManager::DiagonalGridCosts()
     const int32 Thickness = 1;
     const int32 CenterDiag = CenterX + CenterY;
 
-    for (FGridCell& Cell : Grid)
+    ParallelForRows(GridWidth, GridHeight, [&](int32 y)
     {
-        if (Cell.X >= MinX && Cell.X <= MaxX &&
-            Cell.Y >= MinY && Cell.Y <= MaxY)
+        for (int32 x = 0; x < GridWidth; x++)
         {
-            continue;
-        }
+            if (x >= MinX && x <= MaxX && y >= MinY && y <= MaxY) continue;
 
-        int32 Diag = Cell.X + Cell.Y;
+            FGridCell& Cell = Grid[XYToIndex(x, y)];
+            const int32 Diag = x + y;
 
-		bool bDiagA = FMath::Abs(Diag - CenterDiag - 3) <= Thickness;
-        bool bDiagB = FMath::Abs(Diag - (CenterDiag + DiagonalOffset)) <= Thickness;
-        bool bDiagC = FMath::Abs(Diag - (CenterDiag + 2 * DiagonalOffset)) <= Thickness;
+            const bool bDiagA = FMath::Abs(Diag - CenterDiag - 3) <= Thickness;
+            const bool bDiagB = FMath::Abs(Diag - (CenterDiag + DiagonalOffset)) <= Thickness;
+            const bool bDiagC = FMath::Abs(Diag - (CenterDiag + 2 * DiagonalOffset)) <= Thickness;
 
-        if (bDiagA)
-        {
-            if (Cell.Y % 8 < 6)
+            if (bDiagA)
             {
-                Cell.Cost = -1;
-                Cell.bIsBlocked = true;
+                if (y % 8 < 6)
+                {
+                    Cell.Cost = -1;
+                    Cell.bIsBlocked = true;
+                }
             }
-        }
-		else if (bDiagB)
-		{
-			if (Cell.X % 4 < 2)
+            else if (bDiagB)
             {
-                Cell.Cost = -1;
-                Cell.bIsBlocked = true;
+                if (x % 4 < 2)
+                {
+                    Cell.Cost = -1;
+                    Cell.bIsBlocked = true;
+                }
             }
-		}
-        else if (bDiagC)
-        {
-            if (Cell.Y % 6 < 4)
+            else if (bDiagC)
             {
-                Cell.Cost = -1;
-                Cell.bIsBlocked = true;
+                if (y % 6 < 4)
+                {
+                    Cell.Cost = -1;
+                    Cell.bIsBlocked = true;
+                }
+            }
+            else
+            {
+                Cell.Cost = 1;
+                Cell.bIsBlocked = false;
             }
         }
-        else
-        {
-            Cell.Cost = 1;
-            Cell.bIsBlocked = false;
-        }
-    }
+    });
+
+    NotifyGridChanged();
 }
 
 TArray<const FGridCell*> AGridManager::GetNeighbors(int32 const& X, int32 const& Y) const
@@ -317,3 +1084,397 @@ FVector AGridManager::CellToWorld(const FIntPoint& Cell) const
     return GridOrigin +
         FVector(Cell.X * CellSize - OffsetX, Cell.Y * CellSize - OffsetY, 0);
 }
+
+bool AGridManager::HasLineOfSight(const FIntPoint& From, const FIntPoint& To, int32 MaxCost, int32 MinClearance) const
+{
+    if (!IsInside(From.X, From.Y) || !IsInside(To.X, To.Y)) return false;
+
+    auto IsClear = [&](int32 X, int32 Y)
+    {
+        const int32 Index = XYToIndex(X, Y);
+        return IsWalkable(Index) && Grid[Index].Cost <= MaxCost && GetClearance(Index) >= MinClearance;
+    };
+
+    // Walks every cell the segment between the two centers passes through
+    int32 X = From.X;
+    int32 Y = From.Y;
+    const int32 StepX = To.X > From.X ? 1 : -1;
+    const int32 StepY = To.Y > From.Y ? 1 : -1;
+    const int32 Dx = FMath::Abs(To.X - From.X);
+    const int32 Dy = FMath::Abs(To.Y - From.Y);
+
+    // Error > 0: next crossing is a vertical cell edge, < 0: horizontal, 0: exactly a corner
+    int32 Error = Dx - Dy;
+
+    if (!IsClear(X, Y)) return false;
+
+    for (int32 Remaining = Dx + Dy; Remaining > 0; Remaining--)
+    {
+        if (Error > 0)
+        {
+            X += StepX;
+            Error -= Dy * 2;
+        }
+        else if (Error < 0)
+        {
+            Y += StepY;
+            Error += Dx * 2;
+        }
+        else
+        {
+            // Passing through a corner touches both side cells
+            if (!IsClear(X + StepX, Y) || !IsClear(X, Y + StepY)) return false;
+            X += StepX;
+            Y += StepY;
+            Error += (Dx - Dy) * 2;
+            Remaining--;
+        }
+
+        if (!IsClear(X, Y)) return false;
+    }
+
+    return true;
+}
+
+void AGridManager::PostProcessPath(TArray<FVector>& Path, const FPathPostProcessSettings& Settings, float UnitRadius)
+{
+    const int32 MinClearance = UnitRadius > 0.f ? RadiusToClearance(UnitRadius) : 0;
+    FPathPostProcess::Apply(*this, Settings, Path, PostProcessScratch, MinClearance);
+}
+
+
+void AGridManager::NotifyGridChanged()
+{
+    // Anything may have been edited, so every cell's instance is checked
+    DirtyObstacleAreas.Reset();
+    DirtyObstacleAreas.Add(FIntRect(0, 0, GridWidth - 1, GridHeight - 1));
+    NotifyCellsChanged();
+}
+
+void AGridManager::NotifyCellsChanged()
+{
+    RebuildClearance();
+    InvalidateDerivedData();
+    SyncObstacleInstances();
+    UpdateMemoryStats();
+}
+
+void AGridManager::UpdateMemoryStats()
+{
+    GridMemory.Set(Grid.GetAllocatedSize() + Clearance.GetAllocatedSize() + Occupancy.GetAllocatedSize() +
+        VelocitySum.GetAllocatedSize() + PostProcessScratch.GetAllocatedSize() +
+        CellObstacleInstance.GetAllocatedSize() + FreeObstacleInstances.GetAllocatedSize());
+}
+
+void AGridManager::InvalidateDerivedData(bool bDeferLandmarks)
+{
+    GridVersion++;
+
+    // Old landmarks would no longer be admissible
+    Landmarks.Reset();
+
+    if (!bBuildLandmarks) return;
+
+    if (bDeferLandmarks)
+    {
+        bLandmarkRebuildDeferred = true;
+        ScheduleGridFlush();
+    }
+    else
+    {
+        RebuildLandmarks();
+    }
+}
+
+int32 AGridManager::GetCellClearance(const FIntPoint& Cell) const
+{
+    return IsInside(Cell.X, Cell.Y) ? GetClearance(XYToIndex(Cell.X, Cell.Y)) : 0;
+}
+
+int32 AGridManager::RadiusToClearance(float UnitRadius) const
+{
+    // A unit centered on a cell overlaps the cells within ceil(R / CellSize - 0.5) of it,
+    // all of which must be free, so the nearest obstacle has to be one further out
+    const int32 Reach = FMath::Max(0, FMath::CeilToInt(UnitRadius / CellSize - 0.5f));
+    return FMath::Min(Reach + 1, MaxClearance);
+}
+
+void AGridManager::RebuildClearance()
+{
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_RebuildClearance);
+    LLM_SCOPE_BYTAG(Massive_Grid);
+
+    const int32 Num = GridWidth * GridHeight;
+    if (Grid.Num() != Num || Num == 0)
+    {
+        Clearance.Reset();
+        return;
+    }
+
+    const int32 Cap = FMath::Clamp(MaxClearance, 1, 255);
+
+    // Chebyshev distance transform, separable: first the distance to the nearest blocked cell
+    // along each row, then per column min over rows of max(row distance, column offset).
+    // The grid edge counts as blocked. Both passes are independent per row / column.
+    TArray<uint8> RowDist;
+    RowDist.SetNumUninitialized(Num);
+
+    ParallelFor(GridHeight, [&](int32 Y)
+    {
+        const int32 Row = Y * GridWidth;
+
+        int32 Dist = 0; // distance to the left edge / last blocked cell
+        for (int32 X = 0; X < GridWidth; X++)
+        {
+            Dist = IsWalkable(Row + X) ? FMath::Min(Dist + 1, Cap) : 0;
+            RowDist[Row + X] = uint8(Dist);
+        }
+
+        Dist = 0;
+        for (int32 X = GridWidth - 1; X >= 0; X--)
+        {
+            Dist = IsWalkable(Row + X) ? FMath::Min(Dist + 1, Cap) : 0;
+            RowDist[Row + X] = uint8(FMath::Min<int32>(RowDist[Row + X], Dist));
+        }
+    });
+
+    Clearance.SetNumUninitialized(Num);
+
+    ParallelFor(GridWidth, [&](int32 X)
+    {
+        for (int32 Y = 0; Y < GridHeight; Y++)
+        {
+            const int32 Index = XYToIndex(X, Y);
+            int32 Best = FMath::Min3<int32>(RowDist[Index], Y + 1, GridHeight - Y);
+
+            // Rows further than the best so far can't improve it
+            for (int32 Offset = 1; Offset < Best; Offset++)
+            {
+                if (Y - Offset >= 0) Best = FMath::Min(Best, FMath::Max<int32>(Offset, RowDist[Index - Offset * GridWidth]));
+                if (Y + Offset < GridHeight) Best = FMath::Min(Best, FMath::Max<int32>(Offset, RowDist[Index + Offset * GridWidth]));
+            }
+
+            Clearance[Index] = uint8(Best);
+        }
+    });
+}
+
+void AGridManager::SetCellBlocked(int32 X, int32 Y, bool bBlocked)
+{
+    if (!IsInside(X, Y) || Grid.Num() != GridWidth * GridHeight) return;
+
+    FGridCell& Cell = Grid[XYToIndex(X, Y)];
+    Cell.bIsBlocked = bBlocked;
+    Cell.Cost = bBlocked ? -1 : 1;
+
+    if (Clearance.Num() == Grid.Num())
+    {
+        UpdateClearanceAround(X, Y);
+    }
+    else
+    {
+        RebuildClearance();
+    }
+
+    if (CellObstacleInstance.Num() == Grid.Num() && UpdateObstacleInstance(XYToIndex(X, Y)))
+    {
+        ObstacleInstances->MarkRenderStateDirty();
+    }
+
+    // Cells are often painted or moved many per frame, only rebuild landmarks once for all of them
+    InvalidateDerivedData(true);
+}
+
+void AGridManager::UpdateOccupancy(const TArray<FVector>& UnitLocations)
+{
+    UpdateOccupancyInternal(UnitLocations, nullptr);
+}
+
+void AGridManager::UpdateOccupancyWithVelocities(const TArray<FVector>& UnitLocations, const TArray<FVector>& UnitVelocities)
+{
+    UpdateOccupancyInternal(UnitLocations, UnitVelocities.Num() == UnitLocations.Num() ? &UnitVelocities : nullptr);
+}
+
+void AGridManager::UpdateOccupancyInternal(const TArray<FVector>& UnitLocations, const TArray<FVector>* UnitVelocities)
+{
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_UpdateOccupancy);
+    LLM_SCOPE_BYTAG(Massive_Grid);
+
+    const int32 Num = GridWidth * GridHeight;
+    if (Occupancy.Num() != Num)
+    {
+        Occupancy.SetNumUninitialized(Num);
+    }
+    if (Num == 0) return;
+
+    FMemory::Memzero(Occupancy.GetData(), Occupancy.Num() * sizeof(int32));
+
+    if (UnitVelocities)
+    {
+        VelocitySum.SetNumUninitialized(Num);
+        FMemory::Memzero(VelocitySum.GetData(), VelocitySum.Num() * sizeof(FIntPoint));
+    }
+    else
+    {
+        VelocitySum.Reset();
+    }
+    UpdateMemoryStats();
+
+    // Batched so each task does enough work to be worth scheduling; many units share a
+    // cell, so counts are bumped atomically instead of binned per thread
+    constexpr int32 BatchSize = 1024;
+    const int32 NumBatches = FMath::DivideAndRoundUp(UnitLocations.Num(), BatchSize);
+
+    const float OffsetX = (GridWidth * CellSize) * 0.5f - CellSize * 0.5f;
+    const float OffsetY = (GridHeight * CellSize) * 0.5f - CellSize * 0.5f;
+    const float InvCellSize = 1.f / CellSize;
+
+    ParallelFor(NumBatches, [&](int32 Batch)
+    {
+        const int32 First = Batch * BatchSize;
+        const int32 Last = FMath::Min(First + BatchSize, UnitLocations.Num());
+        for (int32 i = First; i < Last; i++)
+        {
+            // Same mapping as WorldToCell, without the clamp: units off the grid don't count
+            const FVector Local = UnitLocations[i] - GridOrigin;
+            const int32 X = FMath::RoundToInt((Local.X + OffsetX) * InvCellSize);
+            const int32 Y = FMath::RoundToInt((Local.Y + OffsetY) * InvCellSize);
+            if (!IsInside(X, Y)) continue;
+
+            const int32 Index = XYToIndex(X, Y);
+            FPlatformAtomics::InterlockedIncrement(&Occupancy[Index]);
+
+            if (UnitVelocities)
+            {
+                const FVector& Velocity = (*UnitVelocities)[i];
+                FPlatformAtomics::InterlockedAdd(&VelocitySum[Index].X, FMath::RoundToInt(Velocity.X));
+                FPlatformAtomics::InterlockedAdd(&VelocitySum[Index].Y, FMath::RoundToInt(Velocity.Y));
+            }
+        }
+    });
+}
+
+int32 AGridManager::GetCellOccupancy(const FIntPoint& Cell) const
+{
+    return IsInside(Cell.X, Cell.Y) ? GetOccupancy(XYToIndex(Cell.X, Cell.Y)) : 0;
+}
+
+void AGridManager::UpdateClearanceAround(int32 X, int32 Y)
+{
+    const int32 Cap = FMath::Clamp(MaxClearance, 1, 255);
+
+    auto IsBlockedOrOutside = [&](int32 CX, int32 CY)
+    {
+        return !IsInside(CX, CY) || !IsWalkable(XYToIndex(CX, CY));
+    };
+
+    // Only cells within Cap of the change can see it as their nearest obstacle
+    for (int32 CY = FMath::Max(0, Y - Cap); CY <= FMath::Min(GridHeight - 1, Y + Cap); CY++)
+    {
+        for (int32 CX = FMath::Max(0, X - Cap); CX <= FMath::Min(GridWidth - 1, X + Cap); CX++)
+        {
+            const int32 Index = XYToIndex(CX, CY);
+            if (!IsWalkable(Index))
+            {
+                Clearance[Index] = 0;
+                continue;
+            }
+
+            // Grow square rings until one touches an obstacle or the edge
+            int32 Dist = Cap;
+            for (int32 Ring = 1; Ring < Cap && Dist == Cap; Ring++)
+            {
+                for (int32 i = -Ring; i <= Ring; i++)
+                {
+                    if (IsBlockedOrOutside(CX + i, CY - Ring) || IsBlockedOrOutside(CX + i, CY + Ring) ||
+                        IsBlockedOrOutside(CX - Ring, CY + i) || IsBlockedOrOutside(CX + Ring, CY + i))
+                    {
+                        Dist = Ring;
+                        break;
+                    }
+                }
+            }
+
+            Clearance[Index] = uint8(Dist);
+        }
+    }
+}
+
+FGridCostField AGridManager::MakeCostField() const
+{
+    FGridCostField Field;
+    Field.Width = GridWidth;
+    Field.Height = GridHeight;
+    Field.Costs.SetNumUninitialized(Grid.Num());
+
+    for (int32 i = 0; i < Grid.Num(); i++)
+    {
+        const FGridCell& Cell = Grid[i];
+        const bool bWalkable = !Cell.bIsBlocked && Cell.Cost < 500;
+        Field.Costs[i] = bWalkable ? FMath::Max(1, Cell.Cost) : -1;
+    }
+
+    return Field;
+}
+
+TSharedPtr<const FGridLandmarks> AGridManager::GetLandmarks() const
+{
+    if (Landmarks.IsValid() && Landmarks->GetGridVersion() == GridVersion && Landmarks->GetNumCells() == Grid.Num())
+    {
+        return Landmarks;
+    }
+    return nullptr;
+}
+
+void AGridManager::RebuildLandmarks()
+{
+    if (Grid.Num() == 0) return;
+
+    // Background builds land on whatever frame they finish, and searches started before
+    // that would take different (equally short) paths
+    if (bDeterministic)
+    {
+        bLandmarkRebuildPending = false;
+        Landmarks = FGridLandmarks::Build(MakeCostField(), NumLandmarks, LandmarkDiagonalCost, GridVersion);
+        return;
+    }
+
+    // Coalesce requests while a build is running, the newest grid wins
+    if (bLandmarkBuildInFlight)
+    {
+        bLandmarkRebuildPending = true;
+        return;
+    }
+
+    bLandmarkBuildInFlight = true;
+    bLandmarkRebuildPending = false;
+
+    const int32 Version = GridVersion;
+    const int32 Count = NumLandmarks;
+    const float DiagCost = LandmarkDiagonalCost;
+    TWeakObjectPtr<AGridManager> WeakThis(this);
+
+    Async(EAsyncExecution::ThreadPool, [WeakThis, Field = MakeCostField(), Count, DiagCost, Version]()
+    {
+        TSharedPtr<const FGridLandmarks> Result = FGridLandmarks::Build(Field, Count, DiagCost, Version);
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Result, Version]()
+        {
+            AGridManager* GridManager = WeakThis.Get();
+            if (!GridManager) return;
+
+            GridManager->bLandmarkBuildInFlight = false;
+            if (Version == GridManager->GridVersion)
+            {
+                GridManager->Landmarks = Result;
+                UE_LOG(LogTemp, Log, TEXT("GridManager: Built %d landmarks (%.1f KB)"),
+                    Result->GetNumLandmarks(), Result->GetAllocatedSize() / 1024.f);
+            }
+
+            if (GridManager->bLandmarkRebuildPending)
+            {
+                GridManager->RebuildLandmarks();
+            }
+        });
+    });
+}
@@ -2,20 +2,25 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "WorldCollision.h"
+#include "GridCostField.h"
+#include "GridLandmarks.h"
+#include "PathPostProcess.h"
+#include "MassiveStats.h"
 #include "GridManager.generated.h"
 
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+
 USTRUCT(BlueprintType, Blueprintable)
 struct FGridCell
 {
 	GENERATED_BODY()
 
-	// Universal grid position
+	// Universal grid position, AGridManager::CellToWorld gives the world-space center
 	int32 X;
 	int32 Y;
 
-	// Universal world-space location
-	FVector WorldLocation;
-
 	// Shared between FlowField and Theta*
 	int32 Cost = 1;           // 1 = walkable, -1 = blocked
 	bool bIsBlocked = false;
@@ -68,12 +73,91 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid")
 	int32 IgnoreSpawnDimension = 0;
+
+	// SpawnObstacles draws every blocked cell as an instance of ObstacleMesh on ObstacleInstances,
+	// added in one batch, instead of spawning an actor per cell. The instances then follow the
+	// grid: cells that get blocked or unblocked later only touch their own instance.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Obstacles")
+	bool bInstancedObstacles = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Obstacles", meta=(EditCondition="bInstancedObstacles"))
+	UStaticMesh* ObstacleMesh = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Obstacles", meta=(EditCondition="bInstancedObstacles"))
+	FVector ObstacleMeshScale = FVector::OneVector;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Grid|Obstacles")
+	UHierarchicalInstancedStaticMeshComponent* ObstacleInstances = nullptr;
+
+	// Precompute ALT landmark distance fields whenever the grid changes (built in the background)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Landmarks")
+	bool bBuildLandmarks = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Landmarks", meta=(ClampMin="1", ClampMax="32"))
+	int32 NumLandmarks = 8;
+
+	// Must not be larger than the DiagonalCost of the searches using the landmarks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Landmarks", meta=(ClampMin="1.0", ClampMax="2.0"))
+	float LandmarkDiagonalCost = 1.41421356237f;
+	
+	// Seed for RandomizeGridCosts, reapplied by every GenerateGrid so the same seed gives the
+	// same layout. 0 picks a new seed each time; GetActiveSeed() (and the log) tells which.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Determinism")
+	int32 RandomSeed = 0;
+
+	// Lockstep mode for replays and perf comparisons: landmarks are built synchronously, boids
+	// sort their neighbors and flow controllers on this grid advance by DeterministicTimeStep
+	// per tick and rebuild on the frame they decide to, instead of in the background.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Determinism")
+	bool bDeterministic = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Determinism", meta=(ClampMin="0.001", EditCondition="bDeterministic"))
+	float DeterministicTimeStep = 1.f / 30.f;
+
+	// GenerateGrid loads this file instead of generating when it exists (see LoadBakedGrid).
+	// Packaged builds need its folder under "Additional Non-Asset Directories to Package".
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Bake")
+	bool bUseBakedGrid = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Bake")
+	FString BakedGridPath = TEXT("Content/Grids/Grid.massivegrid");
+
+	// BakeCollision tests a box per cell, CellSize wide (minus the inset on each side) and this
+	// tall, standing on GridOrigin.Z. Components blocking the channel block the cell, components
+	// only overlapping it (mud, shallow water volumes) give it CollisionOverlapCost instead.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision")
+	TEnumAsByte<ECollisionChannel> CollisionBakeChannel = ECC_WorldStatic;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision", meta=(ClampMin="1.0"))
+	float CollisionBakeHeight = 200.f;
+
+	// Keeps geometry that only touches a cell's edge from claiming it
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision", meta=(ClampMin="0.0"))
+	float CollisionCellInset = 5.f;
+
+	// 0 ignores overlap-only components
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision", meta=(ClampMin="0", ClampMax="499"))
+	int32 CollisionOverlapCost = 5;
+
+	// Cells per side of the blocks the bake issues one overlap query for
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision", meta=(ClampMin="1", ClampMax="256"))
+	int32 CollisionBakeBlockSize = 16;
+
+	// Rebake the cells under movable components found by the bake whenever they move
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Collision")
+	bool bRebakeMovedObstacles = true;
+
+	// Clearance is tracked up to this many cells; larger units all count as this size
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grid|Clearance", meta=(ClampMin="1", ClampMax="255"))
+	int32 MaxClearance = 8;
 	
 	TArray<FGridCell> Grid;
 	
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Destroyed() override;
 
 public:	
 	// Core functions
@@ -88,8 +172,56 @@ public:
 	
 	void RandomizeGridCosts(float Chance = 0.2f);
 
+	UFUNCTION(BlueprintPure, Category="Grid|Determinism")
+	int32 GetActiveSeed() const { return RandomStream.GetInitialSeed(); }
+
+	// CRC of every cell's cost, blocked flag and flow data. Two runs that did the same
+	// things in the same order end with the same checksum.
+	UFUNCTION(BlueprintPure, Category="Grid|Determinism")
+	int32 ComputeChecksum() const;
+
+	// Replaces the grid with a Moving AI benchmark map (.map, "type octile"). '.', 'G' and 'S'
+	// are walkable, everything else is blocked. Row 0 of the file is y = 0, the same cell
+	// coordinates .scen files use. Returns false if the file can't be read or parsed.
+	UFUNCTION(BlueprintCallable)
+	bool ImportMovingAIMap(const FString& FilePath);
+
+	// Writes costs, the blocked bitmap, clearance and landmarks (built now if bBuildLandmarks and
+	// they aren't ready yet) to a versioned binary file. Relative paths are under the project dir.
+	UFUNCTION(BlueprintCallable, Category="Grid|Bake")
+	bool SaveBakedGrid(const FString& FilePath);
+
+	// Replaces the grid with a baked one. The file is memory mapped and the cells are built
+	// straight from it, so nothing is regenerated or recomputed. False if the file is missing,
+	// from another format version, truncated or has section sizes that don't match its header;
+	// the grid is left untouched then.
+	UFUNCTION(BlueprintCallable, Category="Grid|Bake")
+	bool LoadBakedGrid(const FString& FilePath);
+
+	// Bakes the current grid to BakedGridPath
+	UFUNCTION(CallInEditor, Category="Grid|Bake")
+	void BakeGrid();
+
+	// Derives cost and blocked state of every cell from world collision (see CollisionBakeChannel).
+	// Issues one overlap per cell block; in game worlds they are async and the results arrive
+	// over the next frame, elsewhere (editor, commandlets) they run on the game thread before
+	// this returns. The grid is notified once the last block is in.
+	UFUNCTION(CallInEditor, BlueprintCallable, Category="Grid|Collision")
+	void BakeCollision();
+
+	// Same as BakeCollision, but only for the blocks touching WorldArea
+	UFUNCTION(BlueprintCallable, Category="Grid|Collision")
+	void RebakeCollision(const FBox& WorldArea);
+
+	bool IsCollisionBakeInFlight() const { return PendingCollisionBlocks.Num() > 0; }
+
+	// ObstacleClass is unused in instanced mode (see bInstancedObstacles)
 	UFUNCTION(BlueprintCallable)
 	void SpawnObstacles(TSubclassOf<AActor> ObstacleClass);
+
+	// Removes all obstacle instances and stops keeping them in step with the grid
+	UFUNCTION(BlueprintCallable, Category="Grid|Obstacles")
+	void ClearObstacleInstances();
 	
 	UFUNCTION(BlueprintCallable)
 	void DiagonalGridCosts();
@@ -107,6 +239,186 @@ public:
 		return X >= 0 && X < GridWidth && Y >= 0 && Y < GridHeight;
 	}
 
+	// Same rule as GetNeighbors
+	FORCEINLINE bool IsWalkable(int32 Index) const
+	{
+		return Grid[Index].Cost < 500 && !Grid[Index].bIsBlocked;
+	}
+
 	FIntPoint WorldToCell(const FVector& WorldLocation) const;
 	FVector CellToWorld(const FIntPoint& Cell) const;
+
+	// True if the segment between the two cell centers only crosses walkable cells with Cost <= MaxCost
+	// and clearance >= MinClearance. A segment through a cell corner needs both cells beside the
+	// corner, like diagonal moves.
+	bool HasLineOfSight(const FIntPoint& From, const FIntPoint& To, int32 MaxCost = MAX_int32, int32 MinClearance = 0) const;
+
+	// Chebyshev distance in cells from the cell to the nearest blocked cell or the grid edge,
+	// capped at MaxClearance (0 for blocked cells). A unit fits on a cell when its clearance is
+	// at least RadiusToClearance(UnitRadius).
+	FORCEINLINE int32 GetClearance(int32 Index) const
+	{
+		return Clearance.IsValidIndex(Index) ? Clearance[Index] : MAX_uint8;
+	}
+
+	UFUNCTION(BlueprintPure, Category="Grid|Clearance")
+	int32 GetCellClearance(const FIntPoint& Cell) const;
+
+	// Clearance a unit of this radius needs, standing at a cell center (1 = any walkable cell)
+	UFUNCTION(BlueprintPure, Category="Grid|Clearance")
+	int32 RadiusToClearance(float UnitRadius) const;
+
+	// Recomputes the whole clearance field in parallel. NotifyGridChanged does this for you.
+	UFUNCTION(BlueprintCallable, Category="Grid|Clearance")
+	void RebuildClearance();
+
+	// Blocks or unblocks one cell and only updates the clearance around it. Landmarks are rebuilt
+	// once on the next tick for all cells changed this frame.
+	UFUNCTION(BlueprintCallable, Category="Grid")
+	void SetCellBlocked(int32 X, int32 Y, bool bBlocked);
+
+	// Rebuilds the unit occupancy layer (units per cell) from scratch. Meant to be called once a
+	// frame by whatever owns the unit positions; units outside the grid are ignored.
+	// Occupancy is dynamic, so it doesn't bump the grid version.
+	UFUNCTION(BlueprintCallable, Category="Grid|Occupancy")
+	void UpdateOccupancy(const TArray<FVector>& UnitLocations);
+
+	// Same as UpdateOccupancy, and also tracks the average unit velocity per cell (continuum crowd
+	// flow fields). UnitVelocities must line up with UnitLocations.
+	UFUNCTION(BlueprintCallable, Category="Grid|Occupancy")
+	void UpdateOccupancyWithVelocities(const TArray<FVector>& UnitLocations, const TArray<FVector>& UnitVelocities);
+
+	FORCEINLINE int32 GetOccupancy(int32 Index) const
+	{
+		return Occupancy.IsValidIndex(Index) ? Occupancy[Index] : 0;
+	}
+
+	// Average velocity of the units on the cell (cm/s), zero if none or velocities aren't tracked
+	FORCEINLINE FVector2f GetAverageVelocity(int32 Index) const
+	{
+		if (!VelocitySum.IsValidIndex(Index) || GetOccupancy(Index) == 0) return FVector2f::ZeroVector;
+		return FVector2f(float(VelocitySum[Index].X), float(VelocitySum[Index].Y)) / float(GetOccupancy(Index));
+	}
+
+	const TArray<int32>& GetOccupancyField() const { return Occupancy; }
+	const TArray<uint8>& GetClearanceField() const { return Clearance; }
+
+	UFUNCTION(BlueprintPure, Category="Grid|Occupancy")
+	int32 GetCellOccupancy(const FIntPoint& Cell) const;
+
+	// Runs the path post-processing pipeline on any world-space path, in place.
+	// Pass the unit's radius so string pulling doesn't cut through gaps it can't fit.
+	UFUNCTION(BlueprintCallable, Category="Grid|Path")
+	void PostProcessPath(UPARAM(ref) TArray<FVector>& Path, const FPathPostProcessSettings& Settings, float UnitRadius = 0.f);
+
+	// Call after editing Grid so cached data derived from it (landmarks, ...) gets rebuilt
+	UFUNCTION(BlueprintCallable, Category="Grid")
+	void NotifyGridChanged();
+
+	int32 GetGridVersion() const { return GridVersion; }
+
+	// Flat copy of the current costs, safe to read from other threads
+	FGridCostField MakeCostField() const;
+
+	// Landmarks matching the current grid, or null while they are (re)building
+	TSharedPtr<const FGridLandmarks> GetLandmarks() const;
+
+	UFUNCTION(BlueprintCallable, Category="Grid|Landmarks")
+	void RebuildLandmarks();
+
+private:
+	// Bumps the version and drops data derived from the old grid, without touching clearance.
+	// bDeferLandmarks leaves the landmark rebuild to the next grid flush.
+	void InvalidateDerivedData(bool bDeferLandmarks = false);
+
+	// Runs FlushPendingGridChanges next tick (right away outside game worlds)
+	void ScheduleGridFlush();
+
+	// Rebakes the area moved obstacles touched and rebuilds deferred landmarks
+	void FlushPendingGridChanges();
+	bool bGridFlushScheduled = false;
+	bool bLandmarkRebuildDeferred = false;
+
+	// Reseeds RandomStream from RandomSeed
+	void ResetRandomStream();
+	FRandomStream RandomStream;
+
+	// Reports the grid's layers to FMassiveMemory
+	void UpdateMemoryStats();
+	FMassiveMemoryCounter GridMemory{EMassiveMemory::Grid};
+
+	// Recomputes clearance for the cells whose value can depend on cell (X, Y)
+	void UpdateClearanceAround(int32 X, int32 Y);
+
+	// Bumped on every grid change, used to discard stale background results
+	int32 GridVersion = 0;
+
+	TArray<uint8> Clearance;
+
+	void UpdateOccupancyInternal(const TArray<FVector>& UnitLocations, const TArray<FVector>* UnitVelocities);
+
+	// Units per cell, written with atomic increments from worker threads
+	TArray<int32> Occupancy;
+
+	// Summed unit velocity per cell in whole cm/s, integer so it can be accumulated atomically
+	TArray<FIntPoint> VelocitySum;
+
+	TSharedPtr<const FGridLandmarks> Landmarks;
+	bool bLandmarkBuildInFlight = false;
+	bool bLandmarkRebuildPending = false;
+
+	// Cell rectangle (inclusive) an overlap query covers, keyed by its query's UserData
+	struct FCollisionBakeBlock
+	{
+		FIntRect Cells;
+		FIntPoint GridSize = FIntPoint::ZeroValue;
+	};
+
+	void IssueCollisionBake(const FIntPoint& MinCell, const FIntPoint& MaxCell);
+	void OnCollisionOverlap(const FTraceHandle& Handle, FOverlapDatum& Datum);
+	FCollisionShape MakeCollisionBlockShape(const FIntRect& Cells, FVector& OutCenter) const;
+
+	// Resets the block's cells and applies the overlapping components to them. Game thread only,
+	// the per-cell tests go straight to the components.
+	void ClassifyCollisionBlock(const FCollisionBakeBlock& Block, const TArray<FOverlapResult>& Overlaps);
+
+	// Starts watching the movable components among the overlaps and drops destroyed ones (game thread only)
+	void TrackCollisionObstacles(const TArray<FOverlapResult>& Overlaps);
+
+	// Unbinds from every watched component and forgets them
+	void UntrackCollisionObstacles();
+
+	void OnObstacleMoved(USceneComponent* Component, EUpdateTransformFlags Flags, ETeleportType Teleport);
+
+	FOverlapDelegate CollisionOverlapDelegate;
+	TMap<uint32, FCollisionBakeBlock> PendingCollisionBlocks;
+	uint32 NextCollisionBlockId = 0;
+
+	// Movable obstacles the bake found, with the bounds they had when last baked
+	TMap<TWeakObjectPtr<USceneComponent>, FBox> TrackedObstacles;
+	FBox PendingRebakeArea = FBox(ForceInit);
+
+	// Rebuilds every obstacle instance in one batch
+	void RebuildObstacleInstances();
+
+	// Adds or hides the instances of cells in DirtyObstacleAreas whose blocked state no longer matches them
+	void SyncObstacleInstances();
+	bool UpdateObstacleInstance(int32 Index);
+	FTransform MakeObstacleTransform(int32 Index) const;
+
+	// Instance drawn on each cell, INDEX_NONE if none. Empty while instanced obstacles are off.
+	// Instances of unblocked cells are hidden (zero scale) and reused rather than removed,
+	// so the indices stay valid.
+	TArray<int32> CellObstacleInstance;
+	TArray<int32> FreeObstacleInstances;
+
+	// Cell rectangles (inclusive) written since the last sync. NotifyGridChanged marks the whole
+	// grid; collision rebakes only mark their blocks and notify through NotifyCellsChanged.
+	TArray<FIntRect> DirtyObstacleAreas;
+
+	// NotifyGridChanged without marking the whole grid dirty for the obstacle instances
+	void NotifyCellsChanged();
+
+	// Reused by PostProcessPath
+	TArray<FVector> PostProcessScratch;
 };
@@ -0,0 +1,216 @@
+#include "GroupMoveController.h"
+#include "AStarController.h"
+#include "ThetaStarController.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Kismet/GameplayStatics.h"
+
+AGroupMoveController::AGroupMoveController()
+{
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void AGroupMoveController::BeginPlay()
+{
+	Super::BeginPlay();
+	if (!GridManager)
+	{
+		GridManager = Cast<AGridManager>(
+			UGameplayStatics::GetActorOfClass(GetWorld(), AGridManager::StaticClass())
+		);
+	}
+	if (!AStarController)
+	{
+		AStarController = Cast<AAStarController>(
+			UGameplayStatics::GetActorOfClass(GetWorld(), AAStarController::StaticClass())
+		);
+	}
+	if (!ThetaStarController)
+	{
+		ThetaStarController = Cast<AThetaStarController>(
+			UGameplayStatics::GetActorOfClass(GetWorld(), AThetaStarController::StaticClass())
+		);
+	}
+
+	if (!GridManager)
+	{
+		UE_LOG(LogTemp, Error, TEXT("GroupMoveController: Could not find GridManager!"));
+	}
+}
+
+FGroupMoveOrder AGroupMoveController::IssueGroupMove(const TArray<FVector>& UnitLocations, const FVector& GoalWorld)
+{
+	FGroupMoveOrder Order;
+	if (!GridManager || UnitLocations.Num() == 0) return Order;
+
+	FVector Centroid = FVector::ZeroVector;
+	for (const FVector& Location : UnitLocations)
+	{
+		Centroid += Location;
+	}
+	Centroid /= UnitLocations.Num();
+
+	// The centroid of a group split around an obstacle can sit inside it, start from the closest unit instead
+	FVector PathStart = Centroid;
+	const FIntPoint CentroidCell = GridManager->WorldToCell(Centroid);
+	if (!GridManager->IsInside(CentroidCell.X, CentroidCell.Y) ||
+		GridManager->Grid[GridManager->XYToIndex(CentroidCell.X, CentroidCell.Y)].Cost < 0)
+	{
+		float BestDistSq = TNumericLimits<float>::Max();
+		for (const FVector& Location : UnitLocations)
+		{
+			const float DistSq = FVector::DistSquared2D(Location, Centroid);
+			if (DistSq < BestDistSq)
+			{
+				BestDistSq = DistSq;
+				PathStart = Location;
+			}
+		}
+	}
+
+	if (Planner == EGroupPathPlanner::ThetaStar && ThetaStarController)
+	{
+		Order.LeaderPath = ThetaStarController->FindPath(PathStart, GoalWorld);
+	}
+	else if (AStarController)
+	{
+		Order.LeaderPath = AStarController->FindPath(PathStart, GoalWorld);
+	}
+
+	if (Order.LeaderPath.Num() == 0) return Order;
+
+	Order.PathDistances.Reserve(Order.LeaderPath.Num());
+	Order.PathDistances.Add(0.f);
+	for (int32 i = 1; i < Order.LeaderPath.Num(); i++)
+	{
+		Order.PathDistances.Add(Order.PathDistances.Last() + FVector::Dist2D(Order.LeaderPath[i - 1], Order.LeaderPath[i]));
+	}
+
+	// Units are matched to slots in the frame they start in, facing along the first leg
+	FVector Forward = FVector::ForwardVector;
+	for (int32 i = 1; i < Order.LeaderPath.Num(); i++)
+	{
+		const FVector Dir = (Order.LeaderPath[i] - Order.LeaderPath[0]).GetSafeNormal2D();
+		if (!Dir.IsNearlyZero())
+		{
+			Forward = Dir;
+			break;
+		}
+	}
+
+	AssignSlots(UnitLocations, Centroid, Forward, Order);
+	Order.bValid = true;
+	return Order;
+}
+
+void AGroupMoveController::BuildRows(int32 NumUnits, TArray<int32>& OutRowSizes) const
+{
+	OutRowSizes.Reset();
+
+	int32 Remaining = NumUnits;
+	const int32 BoxWidth = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(float(NumUnits))));
+	for (int32 Row = 0; Remaining > 0; Row++)
+	{
+		const int32 Width = Formation == EFormationShape::Wedge ? Row * 2 + 1 : BoxWidth;
+		OutRowSizes.Add(FMath::Min(Width, Remaining));
+		Remaining -= OutRowSizes.Last();
+	}
+}
+
+void AGroupMoveController::AssignSlots(const TArray<FVector>& UnitLocations, const FVector& Centroid, const FVector& Forward,
+	FGroupMoveOrder& Order) const
+{
+	const int32 NumUnits = UnitLocations.Num();
+	const FVector Right(-Forward.Y, Forward.X, 0.f);
+
+	TArray<int32> RowSizes;
+	BuildRows(NumUnits, RowSizes);
+
+	// Units ordered front to back, then each row's chunk left to right. Slots are generated in
+	// the same order, so the i-th unit takes the i-th slot.
+	TArray<int32> Units;
+	Units.Reserve(NumUnits);
+	for (int32 i = 0; i < NumUnits; i++)
+	{
+		Units.Add(i);
+	}
+
+	auto ForwardOf = [&](int32 Unit) { return FVector::DotProduct(UnitLocations[Unit] - Centroid, Forward); };
+	auto RightOf = [&](int32 Unit) { return FVector::DotProduct(UnitLocations[Unit] - Centroid, Right); };
+
+	Units.Sort([&](int32 A, int32 B) { return ForwardOf(A) > ForwardOf(B); });
+
+	Order.SlotOffsets.SetNum(NumUnits);
+
+	// Center the formation on the leader point
+	const float HalfDepth = (RowSizes.Num() - 1) * 0.5f * SlotSpacing;
+
+	int32 First = 0;
+	for (int32 Row = 0; Row < RowSizes.Num(); Row++)
+	{
+		const int32 Count = RowSizes[Row];
+		TArrayView<int32> RowUnits(Units.GetData() + First, Count);
+		Algo::Sort(RowUnits, [&](int32 A, int32 B) { return RightOf(A) < RightOf(B); });
+
+		for (int32 Col = 0; Col < Count; Col++)
+		{
+			const float X = HalfDepth - Row * SlotSpacing;
+			const float Y = (Col - (Count - 1) * 0.5f) * SlotSpacing;
+			Order.SlotOffsets[RowUnits[Col]] = FVector(X, Y, 0.f);
+		}
+
+		First += Count;
+	}
+}
+
+float AGroupMoveController::GetPathLength(const FGroupMoveOrder& Order)
+{
+	return Order.PathDistances.Num() > 0 ? Order.PathDistances.Last() : 0.f;
+}
+
+void AGroupMoveController::SamplePath(const FGroupMoveOrder& Order, float Distance, FVector& OutLocation, FVector& OutForward)
+{
+	const TArray<FVector>& Path = Order.LeaderPath;
+	OutForward = FVector::ForwardVector;
+
+	if (Path.Num() == 1)
+	{
+		OutLocation = Path[0];
+		return;
+	}
+
+	Distance = FMath::Clamp(Distance, 0.f, GetPathLength(Order));
+
+	// Segment [i - 1, i] containing Distance
+	const int32 i = FMath::Clamp(int32(Algo::UpperBound(Order.PathDistances, Distance)), 1, Path.Num() - 1);
+	const float SegmentLength = Order.PathDistances[i] - Order.PathDistances[i - 1];
+	const float Alpha = SegmentLength > KINDA_SMALL_NUMBER ? (Distance - Order.PathDistances[i - 1]) / SegmentLength : 1.f;
+
+	OutLocation = FMath::Lerp(Path[i - 1], Path[i], Alpha);
+
+	const FVector Dir = (Path[i] - Path[i - 1]).GetSafeNormal2D();
+	if (!Dir.IsNearlyZero()) OutForward = Dir;
+}
+
+FVector AGroupMoveController::GetSlotLocation(const FGroupMoveOrder& Order, int32 UnitIndex, float Distance) const
+{
+	if (!Order.bValid || Order.LeaderPath.Num() == 0 || !Order.SlotOffsets.IsValidIndex(UnitIndex)) return FVector::ZeroVector;
+
+	FVector LeaderLocation, Forward;
+	SamplePath(Order, Distance, LeaderLocation, Forward);
+
+	const FVector Right(-Forward.Y, Forward.X, 0.f);
+	const FVector& Offset = Order.SlotOffsets[UnitIndex];
+	const FVector SlotLocation = LeaderLocation + Forward * Offset.X + Right * Offset.Y;
+
+	if (GridManager)
+	{
+		const FIntPoint Cell = GridManager->WorldToCell(SlotLocation);
+		if (!GridManager->IsInside(Cell.X, Cell.Y) || GridManager->Grid[GridManager->XYToIndex(Cell.X, Cell.Y)].Cost < 0)
+		{
+			return LeaderLocation;
+		}
+	}
+
+	return SlotLocation;
+}
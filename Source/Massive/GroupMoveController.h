@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridManager.h"
+#include "GameFramework/Actor.h"
+#include "GroupMoveController.generated.h"
+
+class AAStarController;
+class AThetaStarController;
+
+UENUM(BlueprintType)
+enum class EGroupPathPlanner : uint8
+{
+	AStar,
+	ThetaStar
+};
+
+UENUM(BlueprintType)
+enum class EFormationShape : uint8
+{
+	// Square-ish block, ceil(sqrt(N)) units per row
+	Box,
+	// 1, 3, 5, ... units per row behind the leader
+	Wedge
+};
+
+// One planned group move: a single leader path plus each unit's slot relative to it
+USTRUCT(BlueprintType)
+struct FGroupMoveOrder
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="GroupMove")
+	TArray<FVector> LeaderPath;
+
+	// Distance along LeaderPath at each of its points
+	UPROPERTY(BlueprintReadOnly, Category="GroupMove")
+	TArray<float> PathDistances;
+
+	// Per unit (same order as the locations passed in): slot offset in the formation frame,
+	// X forward along the path, Y to the right
+	UPROPERTY(BlueprintReadOnly, Category="GroupMove")
+	TArray<FVector> SlotOffsets;
+
+	UPROPERTY(BlueprintReadOnly, Category="GroupMove")
+	bool bValid = false;
+};
+
+// Moves a control group as one: one path search for the group, then formation slots along it.
+// Issuing an order costs one A* / Theta* query plus an O(N log N) slot assignment.
+UCLASS()
+class MASSIVE_API AGroupMoveController : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGroupMoveController();
+
+	AGridManager* GridManager;
+	AAStarController* AStarController;
+	AThetaStarController* ThetaStarController;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupMove")
+	EGroupPathPlanner Planner = EGroupPathPlanner::AStar;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupMove")
+	EFormationShape Formation = EFormationShape::Box;
+
+	// Distance between neighbouring slots
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="GroupMove", meta=(ClampMin="1.0"))
+	float SlotSpacing = 150.f;
+
+	// Plans the group's path from its centroid to GoalWorld and assigns every unit a slot
+	UFUNCTION(BlueprintCallable, Category="GroupMove")
+	FGroupMoveOrder IssueGroupMove(const TArray<FVector>& UnitLocations, const FVector& GoalWorld);
+
+	// Where a unit should be once the formation has advanced Distance along the leader path.
+	// Slots that fall on blocked cells collapse onto the path so units funnel through chokepoints.
+	UFUNCTION(BlueprintPure, Category="GroupMove")
+	FVector GetSlotLocation(const FGroupMoveOrder& Order, int32 UnitIndex, float Distance) const;
+
+	UFUNCTION(BlueprintPure, Category="GroupMove")
+	static float GetPathLength(const FGroupMoveOrder& Order);
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	// Slot counts per row, front to back
+	void BuildRows(int32 NumUnits, TArray<int32>& OutRowSizes) const;
+
+	// Matches units to slots by sorting both along the formation axes, so units keep their
+	// relative order and their paths to the slots don't cross
+	void AssignSlots(const TArray<FVector>& UnitLocations, const FVector& Centroid, const FVector& Forward, FGroupMoveOrder& Order) const;
+
+	static void SamplePath(const FGroupMoveOrder& Order, float Distance, FVector& OutLocation, FVector& OutForward);
+};
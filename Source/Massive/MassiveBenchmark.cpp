@@ -0,0 +1,616 @@
+#include "MassiveBenchmark.h"
+#include "AStarSearch.h"
+#include "AStarController.h"
+#include "ThetaStarController.h"
+#include "FlowFieldSolver.h"
+#include "BoidsComponent.h"
+#include "GridManager.h"
+#include "MassiveStats.h"
+#include "Engine/World.h"
+#include "Engine/StaticMeshActor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	// Peak of what the FMassiveMemory categories held during a run, above what they held when it
+	// started. Only the run's own buffers show up, not whatever else the process allocates.
+	// Categories peak independently, so this is the sum of their peaks.
+	struct FMemoryProbe
+	{
+		FMemoryProbe()
+		{
+			for (int32 i = 0; i < (int32)EMassiveMemory::Num; i++)
+			{
+				Before[i] = FMassiveMemory::GetCurrent(EMassiveMemory(i));
+			}
+			FMassiveMemory::ResetPeaks();
+		}
+
+		int64 GetPeakKB() const
+		{
+			int64 Bytes = 0;
+			for (int32 i = 0; i < (int32)EMassiveMemory::Num; i++)
+			{
+				Bytes += FMath::Max<int64>(0, FMassiveMemory::GetPeak(EMassiveMemory(i)) - Before[i]);
+			}
+			return Bytes / 1024;
+		}
+
+		int64 Before[(int32)EMassiveMemory::Num];
+	};
+
+	// Movable units with a boids component, packed into the middle of the grid from a seeded stream.
+	// Dense enough that every unit has neighbors: about 4 units per cell.
+	void SpawnCrowd(AGridManager* Grid, int32 NumUnits, int32 Seed, TArray<AActor*>& OutUnits, TArray<UBoidsComponent*>& OutBoids)
+	{
+		UWorld* World = Grid->GetWorld();
+		FRandomStream Stream(Seed);
+
+		const int32 AreaCells = FMath::Clamp(FMath::CeilToInt(FMath::Sqrt(NumUnits / 4.f)), 1, FMath::Min(Grid->GridWidth, Grid->GridHeight));
+		const FIntPoint AreaMin((Grid->GridWidth - AreaCells) / 2, (Grid->GridHeight - AreaCells) / 2);
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		OutUnits.Reset(NumUnits);
+		OutBoids.Reset(NumUnits);
+
+		for (int32 i = 0; i < NumUnits; i++)
+		{
+			const FIntPoint Cell(AreaMin.X + Stream.RandRange(0, AreaCells - 1), AreaMin.Y + Stream.RandRange(0, AreaCells - 1));
+			const FVector Jitter(Stream.FRandRange(-0.5f, 0.5f) * Grid->CellSize, Stream.FRandRange(-0.5f, 0.5f) * Grid->CellSize, 0.f);
+
+			AStaticMeshActor* Unit = World->SpawnActor<AStaticMeshActor>(Grid->CellToWorld(Cell) + Jitter, FRotator::ZeroRotator, SpawnParams);
+			if (!Unit) continue;
+			Unit->SetMobility(EComponentMobility::Movable);
+
+			UBoidsComponent* Component = NewObject<UBoidsComponent>(Unit);
+			Component->RegisterComponent();
+			Component->GridManager = Grid;
+
+			OutUnits.Add(Unit);
+			OutBoids.Add(Component);
+		}
+	}
+
+	// Euclidean length in cells, which is the octile length for 8-connected paths
+	double CellPathLength(const TArray<FIntPoint>& Path)
+	{
+		double Length = 0.0;
+		for (int32 i = 1; i < Path.Num(); i++)
+		{
+			Length += FVector2D::Distance(FVector2D(Path[i - 1]), FVector2D(Path[i]));
+		}
+		return Length;
+	}
+}
+
+const TCHAR* MassiveBenchmark::GetMapName(EMassiveBenchmarkMap Map)
+{
+	switch (Map)
+	{
+	case EMassiveBenchmarkMap::Open: return TEXT("Open");
+	case EMassiveBenchmarkMap::RandomObstacles: return TEXT("RandomObstacles");
+	case EMassiveBenchmarkMap::DiagonalWalls: return TEXT("DiagonalWalls");
+	default: return TEXT("Unknown");
+	}
+}
+
+AGridManager* MassiveBenchmark::SpawnGrid(UWorld* World, EMassiveBenchmarkMap Map, int32 Size, int32 Seed)
+{
+	if (!World) return nullptr;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	AGridManager* Grid = World->SpawnActor<AGridManager>(SpawnParams);
+	if (!Grid) return nullptr;
+
+	Grid->GridWidth = Size;
+	Grid->GridHeight = Size;
+	Grid->bSpawnObstacles = false;
+	Grid->bDrawDebug = false;
+	Grid->IgnoreSpawnDimension = 0;
+	Grid->RandomSeed = Seed;
+	Grid->GenerateGrid();
+
+	switch (Map)
+	{
+	case EMassiveBenchmarkMap::RandomObstacles:
+		Grid->RandomizeGridCosts(0.25f);
+		break;
+	case EMassiveBenchmarkMap::DiagonalWalls:
+		Grid->DiagonalGridCosts();
+		break;
+	default:
+		break;
+	}
+
+	return Grid;
+}
+
+void MassiveBenchmark::MakeQueries(const AGridManager* Grid, int32 NumQueries, int32 Seed, TArray<FQuery>& OutQueries)
+{
+	OutQueries.Reset();
+	if (!Grid || Grid->Grid.Num() == 0) return;
+
+	FRandomStream Stream(Seed);
+	auto RandomWalkableCell = [&](FIntPoint& OutCell) -> bool
+	{
+		// Bounded retries so a fully blocked map can't hang
+		for (int32 Attempt = 0; Attempt < 64; Attempt++)
+		{
+			const int32 X = Stream.RandRange(0, Grid->GridWidth - 1);
+			const int32 Y = Stream.RandRange(0, Grid->GridHeight - 1);
+			if (Grid->Grid[Grid->XYToIndex(X, Y)].Cost >= 0)
+			{
+				OutCell = FIntPoint(X, Y);
+				return true;
+			}
+		}
+		return false;
+	};
+
+	OutQueries.Reserve(NumQueries);
+	for (int32 i = 0; i < NumQueries; i++)
+	{
+		FQuery Query;
+		if (RandomWalkableCell(Query.Start) && RandomWalkableCell(Query.Goal))
+		{
+			OutQueries.Add(Query);
+		}
+	}
+}
+
+void MassiveBenchmark::RunOpenListBenchmark(const AGridManager* Grid, const TArray<FQuery>& Queries, float DiagonalCost,
+	TArray<FOpenListResult>& OutResults)
+{
+	OutResults.Reset();
+
+	const EPathOpenListType Types[] =
+	{
+		EPathOpenListType::BinaryHeap,
+		EPathOpenListType::QuaternaryHeap,
+		EPathOpenListType::BucketQueue
+	};
+
+	// One search object per run so buffers are reused between queries like a real caller would
+	FAStarSearch Search;
+	for (const EPathOpenListType Type : Types)
+	{
+		FAStarSearchParams Params;
+		Params.OpenList = Type;
+		Params.bUseLandmarks = false;
+
+		FOpenListResult& Result = OutResults.AddDefaulted_GetRef();
+		Result.OpenList = Type;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (const FQuery& Query : Queries)
+		{
+			if (!Search.Init(Grid, Query.Start, Query.Goal, DiagonalCost, Params)) continue;
+			Search.Step();
+
+			Result.NodesExpanded += Search.GetNodesExpanded();
+			if (Search.GetStatus() == EAStarSearchStatus::Found)
+			{
+				Result.PathsFound++;
+				Result.TotalPathCost += Search.GetPathCost();
+			}
+		}
+		Result.Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+}
+
+void MassiveBenchmark::RunPathfindingBenchmarks(AGridManager* Grid, const FString& MapName, const TArray<FQuery>& Queries,
+	TArray<FResultRow>& OutRows)
+{
+	if (!Grid || !Grid->GetWorld()) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	AAStarController* AStar = Grid->GetWorld()->SpawnActor<AAStarController>(SpawnParams);
+	if (AStar)
+	{
+		AStar->GridManager = Grid;
+		AStar->PathCacheSize = 0;
+
+		const EAStarSearchMode Modes[] = { EAStarSearchMode::Optimal, EAStarSearchMode::Weighted, EAStarSearchMode::Focal };
+		for (const EAStarSearchMode Mode : Modes)
+		{
+			AStar->ResetSearchStats();
+
+			FResultRow& Row = OutRows.AddDefaulted_GetRef();
+			Row.Benchmark = TEXT("AStar");
+			Row.Map = MapName;
+			Row.Size = Grid->GridWidth;
+			Row.Variant = UEnum::GetDisplayValueAsText(Mode).ToString();
+			Row.Runs = Queries.Num();
+
+			const FMemoryProbe MemoryProbe;
+			const double StartTime = FPlatformTime::Seconds();
+			for (const FQuery& Query : Queries)
+			{
+				AStar->RunAStar(Query.Start, Query.Goal, Mode, Mode == EAStarSearchMode::Optimal ? 0.f : 0.1f);
+			}
+			Row.TotalMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+
+			const FAStarModeStats Stats = AStar->GetSearchStats(Mode);
+			Row.Succeeded = Stats.PathsFound;
+			Row.NodesExpanded = Stats.NodesExpanded;
+		}
+
+		AStar->Destroy();
+	}
+
+	AThetaStarController* ThetaStar = Grid->GetWorld()->SpawnActor<AThetaStarController>(SpawnParams);
+	if (ThetaStar)
+	{
+		ThetaStar->GridManager = Grid;
+
+		FResultRow& Row = OutRows.AddDefaulted_GetRef();
+		Row.Benchmark = TEXT("ThetaStar");
+		Row.Map = MapName;
+		Row.Size = Grid->GridWidth;
+		Row.Variant = TEXT("LazyThetaStar");
+		Row.Runs = Queries.Num();
+		Row.NodesExpanded = 0;
+
+		const FMemoryProbe MemoryProbe;
+		const double StartTime = FPlatformTime::Seconds();
+		for (const FQuery& Query : Queries)
+		{
+			if (ThetaStar->RunThetaStar(Query.Start, Query.Goal).Num() > 0) Row.Succeeded++;
+			Row.NodesExpanded += ThetaStar->LastNodesExpanded;
+		}
+		Row.TotalMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+
+		ThetaStar->Destroy();
+	}
+}
+
+void MassiveBenchmark::RunFlowFieldBenchmarks(const AGridManager* Grid, const FString& MapName, const TArray<FQuery>& Queries,
+	int32 NumFields, TArray<FResultRow>& OutRows)
+{
+	if (!Grid || Grid->Grid.Num() == 0) return;
+
+	const int32 NumBuilds = FMath::Min(NumFields, Queries.Num());
+	const TSharedPtr<const FGridCostField> Field = MakeShared<const FGridCostField>(Grid->MakeCostField());
+
+	const EFlowFieldMethod Methods[] = { EFlowFieldMethod::Wavefront, EFlowFieldMethod::Eikonal };
+	for (const EFlowFieldMethod Method : Methods)
+	{
+		FFlowFieldProblem Problem;
+		Problem.Field = Field;
+		Problem.Method = Method;
+
+		// Like a controller, keep the solution and scratch around between builds and report them
+		FFlowFieldSolution Solution;
+		FFlowFieldScratch Scratch;
+		FMassiveMemoryCounter FlowMemory(EMassiveMemory::FlowField);
+
+		FResultRow& Row = OutRows.AddDefaulted_GetRef();
+		Row.Benchmark = TEXT("FlowField");
+		Row.Map = MapName;
+		Row.Size = Grid->GridWidth;
+		Row.Variant = UEnum::GetDisplayValueAsText(Method).ToString();
+		Row.Runs = NumBuilds;
+
+		const FMemoryProbe MemoryProbe;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumBuilds; i++)
+		{
+			Problem.Sources = { Grid->XYToIndex(Queries[i].Goal.X, Queries[i].Goal.Y) };
+			FFlowFieldSolver::Solve(Problem, Solution, Scratch);
+			FlowMemory.Set(Solution.GetAllocatedSize() + Scratch.GetAllocatedSize());
+
+			const int32 Start = Grid->XYToIndex(Queries[i].Start.X, Queries[i].Start.Y);
+			if (Solution.Integration[Start] < FLT_MAX) Row.Succeeded++;
+		}
+		Row.TotalMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+	}
+}
+
+void MassiveBenchmark::RunCrowdBenchmark(AGridManager* Grid, int32 NumUnits, int32 Seed, TArray<FResultRow>& OutRows)
+{
+	if (!Grid || !Grid->GetWorld() || Grid->Grid.Num() == 0) return;
+
+	TArray<AActor*> Units;
+	TArray<UBoidsComponent*> Boids;
+	SpawnCrowd(Grid, NumUnits, Seed, Units, Boids);
+
+	FResultRow& Row = OutRows.AddDefaulted_GetRef();
+	Row.Benchmark = TEXT("Boids");
+	Row.Map = TEXT("Open");
+	Row.Size = Grid->GridWidth;
+	Row.Variant = FString::Printf(TEXT("%d units"), Boids.Num());
+	Row.Runs = Boids.Num();
+
+	const FMemoryProbe MemoryProbe;
+	const double StartTime = FPlatformTime::Seconds();
+	for (UBoidsComponent* Component : Boids)
+	{
+		if (!Component->ComputeBoidsOffset().IsNearlyZero()) Row.Succeeded++;
+	}
+	Row.TotalMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+
+	for (AActor* Unit : Units)
+	{
+		Unit->Destroy();
+	}
+}
+
+uint32 MassiveBenchmark::RunDeterminismPass(UWorld* World, int32 Size, int32 NumUnits, int32 NumSteps, int32 Seed)
+{
+	AGridManager* Grid = SpawnGrid(World, EMassiveBenchmarkMap::RandomObstacles, Size, Seed);
+	if (!Grid) return 0;
+	Grid->bDeterministic = true;
+
+	// Field toward the walkable cell nearest the far corner
+	FFlowFieldProblem Problem;
+	Problem.Field = MakeShared<const FGridCostField>(Grid->MakeCostField());
+	for (int32 Cell = Problem.GetField().Num() - 1; Cell >= 0; Cell--)
+	{
+		if (Problem.GetField().IsWalkable(Cell))
+		{
+			Problem.Sources = { Cell };
+			break;
+		}
+	}
+
+	FFlowFieldSolution Solution;
+	FFlowFieldSolver::Solve(Problem, Solution);
+
+	uint32 Crc = (uint32)Grid->ComputeChecksum();
+	Crc = FCrc::MemCrc32(Solution.Integration.GetData(), Solution.Integration.Num() * sizeof(float), Crc);
+
+	TArray<AActor*> Units;
+	TArray<UBoidsComponent*> Boids;
+	SpawnCrowd(Grid, NumUnits, Seed, Units, Boids);
+
+	// Fixed steps; every offset is computed before anyone moves, so unit order doesn't matter either
+	constexpr float Speed = 300.f;
+	const float Step = Grid->DeterministicTimeStep;
+	TArray<FVector> Offsets;
+	Offsets.SetNum(Units.Num());
+
+	for (int32 StepIndex = 0; StepIndex < NumSteps; StepIndex++)
+	{
+		for (int32 i = 0; i < Boids.Num(); i++)
+		{
+			Offsets[i] = Boids[i]->ComputeBoidsOffset();
+		}
+
+		for (int32 i = 0; i < Units.Num(); i++)
+		{
+			const FVector Location = Units[i]->GetActorLocation();
+			const FIntPoint Cell = Grid->WorldToCell(Location);
+			const FVector Flow = Grid->IsInside(Cell.X, Cell.Y) ? Solution.GetDirection(Grid->XYToIndex(Cell.X, Cell.Y)) : FVector::ZeroVector;
+			Units[i]->SetActorLocation(Location + (Flow * Speed + Offsets[i]) * Step);
+		}
+	}
+
+	for (AActor* Unit : Units)
+	{
+		const FVector Location = Unit->GetActorLocation();
+		Crc = FCrc::MemCrc32(&Location, sizeof(Location), Crc);
+		Unit->Destroy();
+	}
+
+	Grid->Destroy();
+	return Crc;
+}
+
+bool MassiveBenchmark::LoadMovingAIScenarios(const FString& FilePath, TArray<FScenario>& OutScenarios)
+{
+	OutScenarios.Reset();
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("LoadMovingAIScenarios: could not read %s"), *FilePath);
+		return false;
+	}
+
+	// bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+	for (const FString& Line : Lines)
+	{
+		TArray<FString> Fields;
+		Line.ParseIntoArray(Fields, TEXT("\t"));
+		if (Fields.Num() < 9) continue;
+
+		FScenario& Scenario = OutScenarios.AddDefaulted_GetRef();
+		Scenario.Bucket = FCString::Atoi(*Fields[0]);
+		Scenario.Start = FIntPoint(FCString::Atoi(*Fields[4]), FCString::Atoi(*Fields[5]));
+		Scenario.Goal = FIntPoint(FCString::Atoi(*Fields[6]), FCString::Atoi(*Fields[7]));
+		Scenario.OptimalLength = FCString::Atod(*Fields[8]);
+	}
+
+	return OutScenarios.Num() > 0;
+}
+
+void MassiveBenchmark::RunScenarioBenchmark(AGridManager* Grid, const FString& MapName, const TArray<FScenario>& Scenarios,
+	TArray<FResultRow>& OutRows)
+{
+	if (!Grid || !Grid->GetWorld()) return;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	// Length error only counts scenarios with a known, non-zero optimum
+	auto AddLengthError = [](const FScenario& Scenario, const TArray<FIntPoint>& Path, double& InOutErrorSum, int32& InOutErrorCount)
+	{
+		if (Path.Num() == 0 || Scenario.OptimalLength <= 0.0) return;
+		InOutErrorSum += CellPathLength(Path) / Scenario.OptimalLength - 1.0;
+		InOutErrorCount++;
+	};
+
+	AAStarController* AStar = Grid->GetWorld()->SpawnActor<AAStarController>(SpawnParams);
+	if (AStar)
+	{
+		AStar->GridManager = Grid;
+		AStar->PathCacheSize = 0;
+		AStar->DiagonalCost = UE_SQRT_2;
+
+		const EAStarSearchMode Modes[] = { EAStarSearchMode::Optimal, EAStarSearchMode::Weighted, EAStarSearchMode::Focal, EAStarSearchMode::Bidirectional };
+		for (const EAStarSearchMode Mode : Modes)
+		{
+			AStar->ResetSearchStats();
+
+			FResultRow& Row = OutRows.AddDefaulted_GetRef();
+			Row.Benchmark = TEXT("AStar");
+			Row.Map = MapName;
+			Row.Size = FMath::Max(Grid->GridWidth, Grid->GridHeight);
+			Row.Variant = UEnum::GetDisplayValueAsText(Mode).ToString();
+			Row.Runs = Scenarios.Num();
+
+			double ErrorSum = 0.0;
+			int32 ErrorCount = 0;
+
+			const FMemoryProbe MemoryProbe;
+			double Seconds = 0.0;
+			for (const FScenario& Scenario : Scenarios)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				const TArray<FIntPoint> Path = AStar->RunAStar(Scenario.Start, Scenario.Goal, Mode, Mode == EAStarSearchMode::Weighted || Mode == EAStarSearchMode::Focal ? 0.1f : 0.f);
+				Seconds += FPlatformTime::Seconds() - StartTime;
+
+				AddLengthError(Scenario, Path, ErrorSum, ErrorCount);
+			}
+			Row.TotalMilliseconds = Seconds * 1000.0;
+			Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+			Row.MeanLengthErrorPercent = ErrorCount > 0 ? ErrorSum / ErrorCount * 100.0 : -1.0;
+
+			const FAStarModeStats Stats = AStar->GetSearchStats(Mode);
+			Row.Succeeded = Stats.PathsFound;
+			Row.NodesExpanded = Stats.NodesExpanded;
+		}
+
+		AStar->Destroy();
+	}
+
+	AThetaStarController* ThetaStar = Grid->GetWorld()->SpawnActor<AThetaStarController>(SpawnParams);
+	if (ThetaStar)
+	{
+		ThetaStar->GridManager = Grid;
+		ThetaStar->DiagonalCost = UE_SQRT_2;
+
+		FResultRow& Row = OutRows.AddDefaulted_GetRef();
+		Row.Benchmark = TEXT("ThetaStar");
+		Row.Map = MapName;
+		Row.Size = FMath::Max(Grid->GridWidth, Grid->GridHeight);
+		Row.Variant = TEXT("LazyThetaStar");
+		Row.Runs = Scenarios.Num();
+		Row.NodesExpanded = 0;
+
+		double ErrorSum = 0.0;
+		int32 ErrorCount = 0;
+
+		const FMemoryProbe MemoryProbe;
+		double Seconds = 0.0;
+		for (const FScenario& Scenario : Scenarios)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			const TArray<FIntPoint> Path = ThetaStar->RunThetaStar(Scenario.Start, Scenario.Goal);
+			Seconds += FPlatformTime::Seconds() - StartTime;
+
+			if (Path.Num() > 0) Row.Succeeded++;
+			Row.NodesExpanded += ThetaStar->LastNodesExpanded;
+
+			// Any-angle paths can come out shorter than the 8-connected optimum, so this may go negative
+			AddLengthError(Scenario, Path, ErrorSum, ErrorCount);
+		}
+		Row.TotalMilliseconds = Seconds * 1000.0;
+		Row.PeakMemoryKB = MemoryProbe.GetPeakKB();
+		Row.MeanLengthErrorPercent = ErrorCount > 0 ? ErrorSum / ErrorCount * 100.0 : -1.0;
+
+		ThetaStar->Destroy();
+	}
+}
+
+FString MassiveBenchmark::ToCsv(const TArray<FResultRow>& Rows)
+{
+	FString Out = TEXT("Benchmark,Map,Size,Variant,Runs,Succeeded,TotalMs,MsPerRun,NodesExpanded,PeakMemoryKB,LengthErrorPercent\n");
+	for (const FResultRow& Row : Rows)
+	{
+		Out += FString::Printf(TEXT("%s,%s,%d,%s,%d,%d,%.4f,%.4f,%lld,%lld,%.4f\n"),
+			*Row.Benchmark, *Row.Map, Row.Size, *Row.Variant, Row.Runs, Row.Succeeded,
+			Row.TotalMilliseconds, Row.Runs > 0 ? Row.TotalMilliseconds / Row.Runs : 0.0,
+			Row.NodesExpanded, Row.PeakMemoryKB, Row.MeanLengthErrorPercent);
+	}
+	return Out;
+}
+
+FString MassiveBenchmark::ToJson(const TArray<FResultRow>& Rows)
+{
+	FString Out = TEXT("[\n");
+	for (int32 i = 0; i < Rows.Num(); i++)
+	{
+		const FResultRow& Row = Rows[i];
+		Out += FString::Printf(TEXT("  {\"benchmark\": \"%s\", \"map\": \"%s\", \"size\": %d, \"variant\": \"%s\", \"runs\": %d, \"succeeded\": %d, ")
+			TEXT("\"totalMs\": %.4f, \"msPerRun\": %.4f, \"nodesExpanded\": %lld, \"peakMemoryKB\": %lld, \"lengthErrorPercent\": %.4f}%s\n"),
+			*Row.Benchmark, *Row.Map, Row.Size, *Row.Variant, Row.Runs, Row.Succeeded,
+			Row.TotalMilliseconds, Row.Runs > 0 ? Row.TotalMilliseconds / Row.Runs : 0.0,
+			Row.NodesExpanded, Row.PeakMemoryKB, Row.MeanLengthErrorPercent, i + 1 < Rows.Num() ? TEXT(",") : TEXT(""));
+	}
+	Out += TEXT("]\n");
+	return Out;
+}
+
+// Massive.Bench.OpenLists [Size=256] [Queries=200] [Seed=1337]
+static void RunOpenListBenchmarkCommand(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Massive.Bench.OpenLists needs a world"));
+		return;
+	}
+
+	const int32 Size = Args.Num() > 0 ? FMath::Max(8, FCString::Atoi(*Args[0])) : 256;
+	const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 200;
+	const int32 Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1337;
+
+	// Octile costs show the float case; a diagonal cost of 2 keeps every cost integral,
+	// where the bucket queue has to match the heaps exactly
+	const float DiagonalCosts[] = { 1.41421356237f, 2.f };
+	const EMassiveBenchmarkMap Maps[] = { EMassiveBenchmarkMap::Open, EMassiveBenchmarkMap::RandomObstacles, EMassiveBenchmarkMap::DiagonalWalls };
+
+	for (const EMassiveBenchmarkMap Map : Maps)
+	{
+		AGridManager* Grid = MassiveBenchmark::SpawnGrid(World, Map, Size, Seed);
+		if (!Grid) continue;
+
+		TArray<MassiveBenchmark::FQuery> Queries;
+		MassiveBenchmark::MakeQueries(Grid, NumQueries, Seed, Queries);
+
+		for (const float DiagonalCost : DiagonalCosts)
+		{
+			TArray<MassiveBenchmark::FOpenListResult> Results;
+			MassiveBenchmark::RunOpenListBenchmark(Grid, Queries, DiagonalCost, Results);
+
+			const double BaselineCost = Results.Num() > 0 ? Results[0].TotalPathCost : 0.0;
+			for (const MassiveBenchmark::FOpenListResult& Result : Results)
+			{
+				UE_LOG(LogTemp, Log, TEXT("OpenList %s %dx%d diag %.3f %s: %d/%d found, %.1f nodes/query, %.3f ms/query, cost %+.4f%% vs binary"),
+					MassiveBenchmark::GetMapName(Map), Size, Size, DiagonalCost,
+					*UEnum::GetDisplayValueAsText(Result.OpenList).ToString(),
+					Result.PathsFound, Queries.Num(),
+					Queries.Num() > 0 ? double(Result.NodesExpanded) / Queries.Num() : 0.0,
+					Queries.Num() > 0 ? Result.Milliseconds / Queries.Num() : 0.0,
+					BaselineCost > 0.0 ? (Result.TotalPathCost / BaselineCost - 1.0) * 100.0 : 0.0);
+			}
+		}
+
+		Grid->Destroy();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GMassiveBenchOpenListsCommand(
+	TEXT("Massive.Bench.OpenLists"),
+	TEXT("Compares A* open lists on generated maps. Args: [Size=256] [Queries=200] [Seed=1337]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunOpenListBenchmarkCommand));
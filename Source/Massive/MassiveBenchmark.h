@@ -0,0 +1,107 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingTypes.h"
+
+class AGridManager;
+class UWorld;
+
+// Map layouts used by the pathfinding benchmarks, built with AGridManager's own generators
+enum class EMassiveBenchmarkMap : uint8
+{
+	Open,
+	RandomObstacles,
+	DiagonalWalls
+};
+
+namespace MassiveBenchmark
+{
+	struct FQuery
+	{
+		FIntPoint Start;
+		FIntPoint Goal;
+	};
+
+	struct FOpenListResult
+	{
+		EPathOpenListType OpenList = EPathOpenListType::BinaryHeap;
+		int32 PathsFound = 0;
+		int64 NodesExpanded = 0;
+		double TotalPathCost = 0.0;
+		double Milliseconds = 0.0;
+	};
+
+	// One line of benchmark output
+	struct FResultRow
+	{
+		// AStar, ThetaStar, FlowField or Boids
+		FString Benchmark;
+		FString Map;
+		int32 Size = 0;
+
+		// Search mode, flow field method or crowd size
+		FString Variant;
+
+		int32 Runs = 0;
+		int32 Succeeded = 0;
+		double TotalMilliseconds = 0.0;
+
+		// -1 where it doesn't apply
+		int64 NodesExpanded = -1;
+
+		// Peak memory the run's Massive buffers (FMassiveMemory categories) grew by
+		int64 PeakMemoryKB = 0;
+
+		// Scenario runs: mean path length over the published optimum, in percent (-1 if unknown)
+		double MeanLengthErrorPercent = -1.0;
+	};
+
+	// One Moving AI scenario (.scen line)
+	struct FScenario
+	{
+		int32 Bucket = 0;
+		FIntPoint Start;
+		FIntPoint Goal;
+		double OptimalLength = 0.0;
+	};
+
+	MASSIVE_API const TCHAR* GetMapName(EMassiveBenchmarkMap Map);
+
+	// Spawns a hidden, square grid manager and fills it with the given layout.
+	// The caller owns the actor and should Destroy() it when done.
+	MASSIVE_API AGridManager* SpawnGrid(UWorld* World, EMassiveBenchmarkMap Map, int32 Size, int32 Seed);
+
+	// Walkable start/goal pairs drawn from a seeded stream, so every open list sees the same queries
+	MASSIVE_API void MakeQueries(const AGridManager* Grid, int32 NumQueries, int32 Seed, TArray<FQuery>& OutQueries);
+
+	// Runs every query once per open list type with a plain optimal A*
+	MASSIVE_API void RunOpenListBenchmark(const AGridManager* Grid, const TArray<FQuery>& Queries, float DiagonalCost,
+		TArray<FOpenListResult>& OutResults);
+
+	// Every query through AAStarController::RunAStar (optimal, weighted and focal) and AThetaStarController::RunThetaStar
+	MASSIVE_API void RunPathfindingBenchmarks(AGridManager* Grid, const FString& MapName, const TArray<FQuery>& Queries,
+		TArray<FResultRow>& OutRows);
+
+	// Full flow field builds toward the first NumFields query goals, once per integration method
+	MASSIVE_API void RunFlowFieldBenchmarks(const AGridManager* Grid, const FString& MapName, const TArray<FQuery>& Queries,
+		int32 NumFields, TArray<FResultRow>& OutRows);
+
+	// One UBoidsComponent::ComputeBoidsOffset per unit for a crowd packed into the middle of the grid
+	MASSIVE_API void RunCrowdBenchmark(AGridManager* Grid, int32 NumUnits, int32 Seed, TArray<FResultRow>& OutRows);
+
+	// Seeded obstacle map, a flow field and NumSteps fixed steps of a boids crowd following it, with the
+	// grid in deterministic mode. Returns a checksum of the map, the field and the final unit positions,
+	// which has to match between passes with the same arguments.
+	MASSIVE_API uint32 RunDeterminismPass(UWorld* World, int32 Size, int32 NumUnits, int32 NumSteps, int32 Seed);
+
+	// Reads a Moving AI .scen file ("version 1" followed by tab separated scenarios)
+	MASSIVE_API bool LoadMovingAIScenarios(const FString& FilePath, TArray<FScenario>& OutScenarios);
+
+	// Runs every scenario through each A* mode and Theta* on a grid loaded with AGridManager::ImportMovingAIMap.
+	// Uses octile moves without corner cutting, the same rules the published optimal lengths use.
+	MASSIVE_API void RunScenarioBenchmark(AGridManager* Grid, const FString& MapName, const TArray<FScenario>& Scenarios,
+		TArray<FResultRow>& OutRows);
+
+	MASSIVE_API FString ToCsv(const TArray<FResultRow>& Rows);
+	MASSIVE_API FString ToJson(const TArray<FResultRow>& Rows);
+}
@@ -0,0 +1,170 @@
+#include "MassiveBenchmarkCommandlet.h"
+#include "MassiveBenchmark.h"
+#include "GridManager.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/DateTime.h"
+
+namespace
+{
+	// "64,256,1024" -> {64, 256, 1024}, or Default if the switch isn't given
+	TArray<int32> ParseIntList(const FString& Params, const TCHAR* Name, const TArray<int32>& Default)
+	{
+		FString Value;
+		if (!FParse::Value(*Params, Name, Value)) return Default;
+
+		TArray<FString> Parts;
+		Value.ParseIntoArray(Parts, TEXT(","));
+
+		TArray<int32> Result;
+		for (const FString& Part : Parts)
+		{
+			const int32 Number = FCString::Atoi(*Part);
+			if (Number > 0) Result.Add(Number);
+		}
+		return Result.Num() > 0 ? Result : Default;
+	}
+}
+
+UMassiveBenchmarkCommandlet::UMassiveBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UMassiveBenchmarkCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> Sizes = ParseIntList(Params, TEXT("Sizes="), { 64, 256, 1024 });
+	const TArray<int32> CrowdSizes = ParseIntList(Params, TEXT("Crowds="), { 100, 500, 1000 });
+
+	int32 NumQueries = 200;
+	int32 NumFields = 10;
+	int32 Seed = 1337;
+	FParse::Value(*Params, TEXT("Queries="), NumQueries);
+	FParse::Value(*Params, TEXT("Fields="), NumFields);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"));
+	FParse::Value(*Params, TEXT("Output="), OutputDir);
+
+	// Actors need a world, but nothing here ticks or begins play
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MassiveBenchmark"));
+	if (!World)
+	{
+		UE_LOG(LogTemp, Error, TEXT("MassiveBenchmark: could not create a world"));
+		return 1;
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	// Same run twice; anything depending on timing, iteration order or unseeded randomness shows up as a mismatch
+	if (FParse::Param(*Params, TEXT("Determinism")))
+	{
+		int32 NumSteps = 120;
+		FParse::Value(*Params, TEXT("Steps="), NumSteps);
+
+		const uint32 First = MassiveBenchmark::RunDeterminismPass(World, Sizes[0], CrowdSizes[0], NumSteps, Seed);
+		const uint32 Second = MassiveBenchmark::RunDeterminismPass(World, Sizes[0], CrowdSizes[0], NumSteps, Seed);
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+
+		if (First != Second)
+		{
+			UE_LOG(LogTemp, Error, TEXT("MassiveBenchmark: determinism check failed, checksums %08x and %08x"), First, Second);
+			return 1;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("MassiveBenchmark: determinism check passed, checksum %08x (%dx%d, %d units, %d steps, seed %d)"),
+			First, Sizes[0], Sizes[0], CrowdSizes[0], NumSteps, Seed);
+		return 0;
+	}
+
+	TArray<MassiveBenchmark::FResultRow> Rows;
+	const EMassiveBenchmarkMap Maps[] = { EMassiveBenchmarkMap::Open, EMassiveBenchmarkMap::RandomObstacles, EMassiveBenchmarkMap::DiagonalWalls };
+
+	FString MapFile, ScenarioFile;
+	const bool bMovingAI = FParse::Value(*Params, TEXT("Map="), MapFile) && FParse::Value(*Params, TEXT("Scen="), ScenarioFile);
+	if (bMovingAI)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		AGridManager* Grid = World->SpawnActor<AGridManager>(SpawnParams);
+		TArray<MassiveBenchmark::FScenario> Scenarios;
+		if (Grid)
+		{
+			Grid->bSpawnObstacles = false;
+			Grid->bDrawDebug = false;
+		}
+
+		if (Grid && Grid->ImportMovingAIMap(MapFile) && MassiveBenchmark::LoadMovingAIScenarios(ScenarioFile, Scenarios))
+		{
+			UE_LOG(LogTemp, Display, TEXT("MassiveBenchmark: %d scenarios on %s"), Scenarios.Num(), *FPaths::GetBaseFilename(MapFile));
+			MassiveBenchmark::RunScenarioBenchmark(Grid, FPaths::GetBaseFilename(MapFile), Scenarios, Rows);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("MassiveBenchmark: could not load %s / %s"), *MapFile, *ScenarioFile);
+		}
+
+		if (Grid) Grid->Destroy();
+	}
+
+	for (const int32 Size : bMovingAI ? TArray<int32>() : Sizes)
+	{
+		for (const EMassiveBenchmarkMap Map : Maps)
+		{
+			AGridManager* Grid = MassiveBenchmark::SpawnGrid(World, Map, Size, Seed);
+			if (!Grid) continue;
+
+			const FString MapName = MassiveBenchmark::GetMapName(Map);
+			UE_LOG(LogTemp, Display, TEXT("MassiveBenchmark: %s %dx%d"), *MapName, Size, Size);
+
+			TArray<MassiveBenchmark::FQuery> Queries;
+			MassiveBenchmark::MakeQueries(Grid, NumQueries, Seed, Queries);
+
+			MassiveBenchmark::RunPathfindingBenchmarks(Grid, MapName, Queries, Rows);
+			MassiveBenchmark::RunFlowFieldBenchmarks(Grid, MapName, Queries, NumFields, Rows);
+
+			// Boids don't care about terrain, one map is enough
+			if (Map == EMassiveBenchmarkMap::Open)
+			{
+				for (const int32 CrowdSize : CrowdSizes)
+				{
+					MassiveBenchmark::RunCrowdBenchmark(Grid, CrowdSize, Seed, Rows);
+				}
+			}
+
+			Grid->Destroy();
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	for (const MassiveBenchmark::FResultRow& Row : Rows)
+	{
+		UE_LOG(LogTemp, Display, TEXT("%-10s %-16s %5d %-14s %d/%d ok, %.3f ms/run, %lld nodes, %lld KB peak, %.3f%% length error"),
+			*Row.Benchmark, *Row.Map, Row.Size, *Row.Variant, Row.Succeeded, Row.Runs,
+			Row.Runs > 0 ? Row.TotalMilliseconds / Row.Runs : 0.0, Row.NodesExpanded, Row.PeakMemoryKB, Row.MeanLengthErrorPercent);
+	}
+
+	const FString BaseName = FPaths::Combine(OutputDir, FString::Printf(TEXT("MassiveBenchmark-%s"), *FDateTime::Now().ToString()));
+	const bool bSaved = FFileHelper::SaveStringToFile(MassiveBenchmark::ToCsv(Rows), *(BaseName + TEXT(".csv")))
+		&& FFileHelper::SaveStringToFile(MassiveBenchmark::ToJson(Rows), *(BaseName + TEXT(".json")));
+
+	if (!bSaved)
+	{
+		UE_LOG(LogTemp, Error, TEXT("MassiveBenchmark: could not write results to %s"), *OutputDir);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("MassiveBenchmark: wrote %s.csv/.json"), *BaseName);
+	return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassiveBenchmarkCommandlet.generated.h"
+
+// Headless pathfinding and crowd benchmarks, writes CSV and JSON to Saved/Benchmarks.
+//   UnrealEditor-Cmd Massive.uproject -run=MassiveBenchmark -nullrhi -unattended
+//     [-Sizes=64,256,1024] [-Queries=200] [-Fields=10] [-Crowds=100,500,1000] [-Seed=1337] [-Output=<dir>]
+// Every map is generated from the seed, so runs with the same arguments are comparable.
+// With -Map=<file.map> -Scen=<file.scen> it runs a Moving AI benchmark scenario set instead,
+// reporting path length error against the published optimal lengths.
+// -Determinism [-Steps=120] runs a seeded map, flow field and boids crowd twice in deterministic
+// mode (first -Sizes and -Crowds entries) and fails if the two checksums differ.
+UCLASS()
+class MASSIVE_API UMassiveBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassiveBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
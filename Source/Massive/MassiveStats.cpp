@@ -0,0 +1,171 @@
+#include "MassiveStats.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+
+UE_TRACE_CHANNEL_DEFINE(MassiveChannel);
+CSV_DEFINE_CATEGORY_MODULE(MASSIVE_API, Massive, true);
+
+DEFINE_STAT(STAT_Massive_GenerateGrid);
+DEFINE_STAT(STAT_Massive_LoadBakedGrid);
+DEFINE_STAT(STAT_Massive_CollisionBake);
+DEFINE_STAT(STAT_Massive_RebuildClearance);
+DEFINE_STAT(STAT_Massive_UpdateOccupancy);
+DEFINE_STAT(STAT_Massive_BuildLandmarks);
+
+DEFINE_STAT(STAT_Massive_AStar);
+DEFINE_STAT(STAT_Massive_AStarBidirectional);
+DEFINE_STAT(STAT_Massive_ThetaStar);
+DEFINE_STAT(STAT_Massive_Cooperative);
+DEFINE_STAT(STAT_Massive_PostProcess);
+
+DEFINE_STAT(STAT_Massive_FlowIntegration);
+DEFINE_STAT(STAT_Massive_FlowEikonal);
+DEFINE_STAT(STAT_Massive_FlowDirections);
+DEFINE_STAT(STAT_Massive_FlowReroot);
+DEFINE_STAT(STAT_Massive_FlowBatch);
+
+DEFINE_STAT(STAT_Massive_BoidsGather);
+DEFINE_STAT(STAT_Massive_BoidsSteer);
+
+DEFINE_STAT(STAT_Massive_NodesExpanded);
+DEFINE_STAT(STAT_Massive_HeapOperations);
+DEFINE_STAT(STAT_Massive_LineOfSightChecks);
+DEFINE_STAT(STAT_Massive_SearchBytes);
+
+DEFINE_STAT(STAT_Massive_PathCacheHits);
+DEFINE_STAT(STAT_Massive_PathCacheMisses);
+DEFINE_STAT(STAT_Massive_PathCacheEvictions);
+
+DEFINE_STAT(STAT_Massive_GridMemory);
+DEFINE_STAT(STAT_Massive_LandmarkMemory);
+DEFINE_STAT(STAT_Massive_SearchMemory);
+DEFINE_STAT(STAT_Massive_FlowFieldMemory);
+DEFINE_STAT(STAT_Massive_PathCacheMemory);
+DEFINE_STAT(STAT_Massive_BoidsMemory);
+
+LLM_DEFINE_TAG(Massive_Grid);
+LLM_DEFINE_TAG(Massive_Landmarks);
+LLM_DEFINE_TAG(Massive_Search);
+LLM_DEFINE_TAG(Massive_FlowField);
+LLM_DEFINE_TAG(Massive_PathCache);
+LLM_DEFINE_TAG(Massive_Boids);
+
+static TAutoConsoleVariable<int32> CVarMassiveMemoryBudgetMB(
+	TEXT("Massive.MemoryBudgetMB"),
+	0,
+	TEXT("Total navigation memory (grids, search buffers, flow fields, path caches, boids) before caches start evicting. 0 = no budget."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithOutputDevice MassiveMemoryCommand(
+	TEXT("Massive.Memory"),
+	TEXT("Prints current and peak navigation memory per category."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FMassiveMemory::Dump));
+
+static FAutoConsoleCommand MassiveMemoryResetPeaksCommand(
+	TEXT("Massive.Memory.ResetPeaks"),
+	TEXT("Resets the peaks printed by Massive.Memory to the current values."),
+	FConsoleCommandDelegate::CreateStatic(&FMassiveMemory::ResetPeaks));
+
+std::atomic<int64> FMassiveMemory::Current[(int32)EMassiveMemory::Num] = {};
+std::atomic<int64> FMassiveMemory::Peak[(int32)EMassiveMemory::Num] = {};
+
+void FMassiveMemory::Add(EMassiveMemory Category, int64 Delta)
+{
+	const int32 Index = (int32)Category;
+	const int64 NewValue = Current[Index].fetch_add(Delta) + Delta;
+
+	int64 OldPeak = Peak[Index].load();
+	while (NewValue > OldPeak && !Peak[Index].compare_exchange_weak(OldPeak, NewValue))
+	{
+	}
+
+	switch (Category)
+	{
+	case EMassiveMemory::Grid: INC_MEMORY_STAT_BY(STAT_Massive_GridMemory, Delta); break;
+	case EMassiveMemory::Landmarks: INC_MEMORY_STAT_BY(STAT_Massive_LandmarkMemory, Delta); break;
+	case EMassiveMemory::Search: INC_MEMORY_STAT_BY(STAT_Massive_SearchMemory, Delta); break;
+	case EMassiveMemory::FlowField: INC_MEMORY_STAT_BY(STAT_Massive_FlowFieldMemory, Delta); break;
+	case EMassiveMemory::PathCache: INC_MEMORY_STAT_BY(STAT_Massive_PathCacheMemory, Delta); break;
+	case EMassiveMemory::Boids: INC_MEMORY_STAT_BY(STAT_Massive_BoidsMemory, Delta); break;
+	default: break;
+	}
+}
+
+int64 FMassiveMemory::GetCurrent(EMassiveMemory Category)
+{
+	return Current[(int32)Category].load();
+}
+
+int64 FMassiveMemory::GetPeak(EMassiveMemory Category)
+{
+	return Peak[(int32)Category].load();
+}
+
+int64 FMassiveMemory::GetTotal()
+{
+	int64 Total = 0;
+	for (int32 i = 0; i < (int32)EMassiveMemory::Num; i++)
+	{
+		Total += Current[i].load();
+	}
+	return Total;
+}
+
+int64 FMassiveMemory::GetBudget()
+{
+	return int64(FMath::Max(0, CVarMassiveMemoryBudgetMB.GetValueOnAnyThread())) * 1024 * 1024;
+}
+
+bool FMassiveMemory::IsOverBudget()
+{
+	const int64 Budget = GetBudget();
+	return Budget > 0 && GetTotal() > Budget;
+}
+
+void FMassiveMemory::ResetPeaks()
+{
+	for (int32 i = 0; i < (int32)EMassiveMemory::Num; i++)
+	{
+		Peak[i].store(Current[i].load());
+	}
+}
+
+void FMassiveMemory::Dump(FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("%-12s %12s %12s"), TEXT("Category"), TEXT("Current KB"), TEXT("Peak KB"));
+
+	int64 PeakSum = 0;
+	for (int32 i = 0; i < (int32)EMassiveMemory::Num; i++)
+	{
+		const EMassiveMemory Category = (EMassiveMemory)i;
+		Ar.Logf(TEXT("%-12s %12.1f %12.1f"), GetName(Category), GetCurrent(Category) / 1024.0, GetPeak(Category) / 1024.0);
+		PeakSum += GetPeak(Category);
+	}
+
+	// Categories peak at different times, so the summed peak is an upper bound
+	Ar.Logf(TEXT("%-12s %12.1f %12.1f"), TEXT("Total"), GetTotal() / 1024.0, PeakSum / 1024.0);
+
+	const int64 Budget = GetBudget();
+	if (Budget > 0)
+	{
+		Ar.Logf(TEXT("Budget %.1f MB, %s"), Budget / (1024.0 * 1024.0), IsOverBudget() ? TEXT("OVER") : TEXT("within"));
+	}
+	else
+	{
+		Ar.Logf(TEXT("No budget (Massive.MemoryBudgetMB = 0)"));
+	}
+}
+
+const TCHAR* FMassiveMemory::GetName(EMassiveMemory Category)
+{
+	switch (Category)
+	{
+	case EMassiveMemory::Grid: return TEXT("Grid");
+	case EMassiveMemory::Landmarks: return TEXT("Landmarks");
+	case EMassiveMemory::Search: return TEXT("Search");
+	case EMassiveMemory::FlowField: return TEXT("FlowField");
+	case EMassiveMemory::PathCache: return TEXT("PathCache");
+	case EMassiveMemory::Boids: return TEXT("Boids");
+	default: return TEXT("?");
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "HAL/LowLevelMemTracker.h"
+#include <atomic>
+
+// Navigation profiling: "stat Massive" in game, the "Massive" channel in Unreal Insights
+// (-trace=cpu,Massive) and the Massive category in CSV captures (csvprofile start/stop).
+
+DECLARE_STATS_GROUP(TEXT("Massive"), STATGROUP_Massive, STATCAT_Advanced);
+
+UE_TRACE_CHANNEL_EXTERN(MassiveChannel, MASSIVE_API);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(MASSIVE_API, Massive);
+
+// Grid
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Grid"), STAT_Massive_GenerateGrid, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Baked Grid"), STAT_Massive_LoadBakedGrid, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision Bake Block"), STAT_Massive_CollisionBake, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild Clearance"), STAT_Massive_RebuildClearance, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Occupancy"), STAT_Massive_UpdateOccupancy, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Landmarks"), STAT_Massive_BuildLandmarks, STATGROUP_Massive, MASSIVE_API);
+
+// Searches
+DECLARE_CYCLE_STAT_EXTERN(TEXT("A* Step"), STAT_Massive_AStar, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("A* Bidirectional"), STAT_Massive_AStarBidirectional, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Theta*"), STAT_Massive_ThetaStar, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cooperative Plan"), STAT_Massive_Cooperative, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Path Post Process"), STAT_Massive_PostProcess, STATGROUP_Massive, MASSIVE_API);
+
+// Flow fields
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Integration"), STAT_Massive_FlowIntegration, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Eikonal"), STAT_Massive_FlowEikonal, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Directions"), STAT_Massive_FlowDirections, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Reroot"), STAT_Massive_FlowReroot, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Batch"), STAT_Massive_FlowBatch, STATGROUP_Massive, MASSIVE_API);
+
+// Boids
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Boids Gather Neighbors"), STAT_Massive_BoidsGather, STATGROUP_Massive, MASSIVE_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Boids Steering"), STAT_Massive_BoidsSteer, STATGROUP_Massive, MASSIVE_API);
+
+// Per-frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_Massive_NodesExpanded, STATGROUP_Massive, MASSIVE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Heap Operations"), STAT_Massive_HeapOperations, STATGROUP_Massive, MASSIVE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Line Of Sight Checks"), STAT_Massive_LineOfSightChecks, STATGROUP_Massive, MASSIVE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Search Bytes Allocated"), STAT_Massive_SearchBytes, STATGROUP_Massive, MASSIVE_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Hits"), STAT_Massive_PathCacheHits, STATGROUP_Massive, MASSIVE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Misses"), STAT_Massive_PathCacheMisses, STATGROUP_Massive, MASSIVE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Evictions"), STAT_Massive_PathCacheEvictions, STATGROUP_Massive, MASSIVE_API);
+
+// Long-lived memory, one per EMassiveMemory category
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Grid Memory"), STAT_Massive_GridMemory, STATGROUP_Massive, MASSIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Landmark Memory"), STAT_Massive_LandmarkMemory, STATGROUP_Massive, MASSIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Search Buffer Memory"), STAT_Massive_SearchMemory, STATGROUP_Massive, MASSIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Flow Field Memory"), STAT_Massive_FlowFieldMemory, STATGROUP_Massive, MASSIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Path Cache Memory"), STAT_Massive_PathCacheMemory, STATGROUP_Massive, MASSIVE_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Boids Memory"), STAT_Massive_BoidsMemory, STATGROUP_Massive, MASSIVE_API);
+
+// LLM tags (run with -llm, then "stat LLMFULL" or an LLM csv) for the same categories
+LLM_DECLARE_TAG_API(Massive_Grid, MASSIVE_API);
+LLM_DECLARE_TAG_API(Massive_Landmarks, MASSIVE_API);
+LLM_DECLARE_TAG_API(Massive_Search, MASSIVE_API);
+LLM_DECLARE_TAG_API(Massive_FlowField, MASSIVE_API);
+LLM_DECLARE_TAG_API(Massive_PathCache, MASSIVE_API);
+LLM_DECLARE_TAG_API(Massive_Boids, MASSIVE_API);
+
+enum class EMassiveMemory : uint8
+{
+	Grid,
+	Landmarks,
+	Search,
+	FlowField,
+	PathCache,
+	Boids,
+	Num
+};
+
+// Current and peak bytes per category, across all grids, controllers and searches.
+// "Massive.Memory" prints them, "Massive.Memory.ResetPeaks" starts a new peak window.
+// Massive.MemoryBudgetMB caps the total; caches evict down to it (see FPathCache).
+struct MASSIVE_API FMassiveMemory
+{
+	static void Add(EMassiveMemory Category, int64 Delta);
+
+	static int64 GetCurrent(EMassiveMemory Category);
+	static int64 GetPeak(EMassiveMemory Category);
+	static int64 GetTotal();
+
+	// 0 = no budget
+	static int64 GetBudget();
+	static bool IsOverBudget();
+
+	static void ResetPeaks();
+	static void Dump(FOutputDevice& Ar);
+
+	static const TCHAR* GetName(EMassiveMemory Category);
+
+private:
+	static std::atomic<int64> Current[(int32)EMassiveMemory::Num];
+	static std::atomic<int64> Peak[(int32)EMassiveMemory::Num];
+};
+
+// The bytes one owner holds in a category. Set() reports the change since the last call and
+// the destructor gives everything back, so owners only ever report their current size.
+// Copies start out empty: the copy reports its own size once it is Set().
+class MASSIVE_API FMassiveMemoryCounter
+{
+public:
+	explicit FMassiveMemoryCounter(EMassiveMemory InCategory) : Category(InCategory) {}
+	FMassiveMemoryCounter(const FMassiveMemoryCounter& Other) : Category(Other.Category) {}
+	FMassiveMemoryCounter& operator=(const FMassiveMemoryCounter&) { return *this; }
+	~FMassiveMemoryCounter() { Set(0); }
+
+	void Set(SIZE_T InBytes)
+	{
+		const int64 NewBytes = (int64)InBytes;
+		if (NewBytes == Bytes) return;
+
+		FMassiveMemory::Add(Category, NewBytes - Bytes);
+		Bytes = NewBytes;
+	}
+
+	SIZE_T Get() const { return (SIZE_T)Bytes; }
+
+private:
+	EMassiveMemory Category;
+	int64 Bytes = 0;
+};
+
+// Cycle stat, Insights event and CSV timing for the rest of the enclosing scope
+#define MASSIVE_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, MassiveChannel); \
+	CSV_SCOPED_TIMING_STAT(Massive, Stat)
+
+// Adds to a per-frame counter in both stat Massive and the CSV capture. Accumulate locally
+// and call this once per search or pass, not per node.
+#define MASSIVE_COUNTER_ADD(Stat, Amount) \
+	INC_DWORD_STAT_BY(Stat, Amount); \
+	CSV_CUSTOM_STAT(Massive, Stat, int32(Amount), ECsvCustomStatOp::Accumulate)
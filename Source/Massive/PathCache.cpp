@@ -0,0 +1,89 @@
+#include "PathCache.h"
+
+void FPathCache::SetMaxEntries(int32 InMaxEntries)
+{
+	InMaxEntries = FMath::Max(0, InMaxEntries);
+	if (InMaxEntries == Entries.Max()) return;
+
+	// TLruCache can't be resized in place
+	Entries.Empty(InMaxEntries);
+	Memory.Set(0);
+}
+
+const TArray<FIntPoint>* FPathCache::Find(const FPathCacheKey& Key, int32 InGridVersion)
+{
+	if (Entries.Max() == 0) return nullptr;
+
+	if (InGridVersion != GridVersion)
+	{
+		Empty();
+		GridVersion = InGridVersion;
+	}
+
+	const TArray<FIntPoint>* Path = Entries.FindAndTouch(Key);
+	if (Path)
+	{
+		MASSIVE_COUNTER_ADD(STAT_Massive_PathCacheHits, 1);
+	}
+	else
+	{
+		MASSIVE_COUNTER_ADD(STAT_Massive_PathCacheMisses, 1);
+	}
+	return Path;
+}
+
+void FPathCache::Add(const FPathCacheKey& Key, int32 InGridVersion, const TArray<FIntPoint>& Path)
+{
+	if (Entries.Max() == 0) return;
+
+	LLM_SCOPE_BYTAG(Massive_PathCache);
+
+	if (InGridVersion != GridVersion)
+	{
+		Empty();
+		GridVersion = InGridVersion;
+	}
+
+	// Evict ourselves rather than letting TLruCache do it, so the byte count stays right
+	if (const TArray<FIntPoint>* Existing = Entries.FindAndTouch(Key))
+	{
+		Memory.Set(Memory.Get() - EntrySize(*Existing));
+	}
+	else if (Entries.Num() >= Entries.Max())
+	{
+		RemoveLeastRecent();
+	}
+
+	Entries.Add(Key, Path);
+	Memory.Set(Memory.Get() + EntrySize(Path));
+
+	TrimToBudget();
+}
+
+int32 FPathCache::TrimToBudget()
+{
+	int32 Evicted = 0;
+	while (Entries.Num() > 0 && FMassiveMemory::IsOverBudget())
+	{
+		RemoveLeastRecent();
+		Evicted++;
+	}
+
+	if (Evicted > 0)
+	{
+		MASSIVE_COUNTER_ADD(STAT_Massive_PathCacheEvictions, Evicted);
+	}
+	return Evicted;
+}
+
+void FPathCache::Empty()
+{
+	Entries.Empty(Entries.Max());
+	Memory.Set(0);
+}
+
+void FPathCache::RemoveLeastRecent()
+{
+	const TArray<FIntPoint> Path = Entries.RemoveLeastRecent();
+	Memory.Set(Memory.Get() - EntrySize(Path));
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "MassiveStats.h"
+
+// Everything besides the grid that decides which path a query returns
+struct FPathCacheKey
+{
+	FIntPoint Start = FIntPoint::ZeroValue;
+	FIntPoint Goal = FIntPoint::ZeroValue;
+	uint8 Mode = 0;
+	float Epsilon = 0.f;
+	int32 MinClearance = 0;
+
+	// Search settings: step costs, how exactly the open list orders nodes, heuristic
+	float DiagonalCost = 0.f;
+	uint8 OpenList = 0;
+	float BucketWidth = 0.f;
+	bool bUseLandmarks = false;
+
+	bool operator==(const FPathCacheKey& Other) const
+	{
+		return Start == Other.Start && Goal == Other.Goal && Mode == Other.Mode && Epsilon == Other.Epsilon &&
+			MinClearance == Other.MinClearance && DiagonalCost == Other.DiagonalCost && OpenList == Other.OpenList &&
+			BucketWidth == Other.BucketWidth && bUseLandmarks == Other.bUseLandmarks;
+	}
+
+	friend uint32 GetTypeHash(const FPathCacheKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.Start), GetTypeHash(Key.Goal));
+		Hash = HashCombine(Hash, GetTypeHash(Key.Mode));
+		Hash = HashCombine(Hash, GetTypeHash(Key.Epsilon));
+		Hash = HashCombine(Hash, GetTypeHash(Key.MinClearance));
+		Hash = HashCombine(Hash, GetTypeHash(Key.DiagonalCost));
+		Hash = HashCombine(Hash, GetTypeHash(Key.OpenList));
+		Hash = HashCombine(Hash, GetTypeHash(Key.BucketWidth));
+		return HashCombine(Hash, GetTypeHash(Key.bUseLandmarks));
+	}
+};
+
+// Least recently used cell paths, for units that keep asking for the same routes
+// (rally points, patrols, reinforcements). All entries are dropped once the grid version
+// changes. Besides its own entry limit the cache gives memory back whenever FMassiveMemory
+// is over Massive.MemoryBudgetMB, so it is the first thing to shrink under pressure.
+class MASSIVE_API FPathCache
+{
+public:
+	// 0 disables the cache and frees its entries
+	void SetMaxEntries(int32 InMaxEntries);
+	int32 GetMaxEntries() const { return Entries.Max(); }
+
+	// Cached path for Key, or null. Also marks it as most recently used.
+	const TArray<FIntPoint>* Find(const FPathCacheKey& Key, int32 GridVersion);
+
+	void Add(const FPathCacheKey& Key, int32 GridVersion, const TArray<FIntPoint>& Path);
+
+	// Evicts least recently used paths until the memory budget holds or the cache is empty.
+	// Returns how many were evicted.
+	int32 TrimToBudget();
+
+	void Empty();
+
+	int32 Num() const { return Entries.Num(); }
+	SIZE_T GetAllocatedSize() const { return Memory.Get(); }
+
+private:
+	static SIZE_T EntrySize(const TArray<FIntPoint>& Path)
+	{
+		return sizeof(FPathCacheKey) + sizeof(TArray<FIntPoint>) + Path.GetAllocatedSize();
+	}
+
+	void RemoveLeastRecent();
+
+	TLruCache<FPathCacheKey, TArray<FIntPoint>> Entries;
+	int32 GridVersion = INDEX_NONE;
+
+	// Approximate: paths plus keys, not the cache's own hash table
+	FMassiveMemoryCounter Memory{EMassiveMemory::PathCache};
+};
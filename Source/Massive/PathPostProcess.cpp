@@ -0,0 +1,117 @@
+#include "PathPostProcess.h"
+#include "GridManager.h"
+#include "MassiveStats.h"
+
+void FPathPostProcess::Apply(const AGridManager& Grid, const FPathPostProcessSettings& Settings, TArray<FVector>& Path, TArray<FVector>& Scratch,
+	int32 MinClearance)
+{
+	MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_PostProcess);
+
+	if (Path.Num() < 3) return;
+
+	// Compressing first leaves fewer points to test line of sight between
+	if (Settings.bCompress) CompressCollinear(Path);
+	if (Settings.bStringPull) StringPull(Grid, Path, Settings.MaxPullCost, MinClearance);
+	if (Settings.bSmooth) SmoothCatmullRom(Grid, Path, Settings.SmoothingSamples, Scratch);
+}
+
+void FPathPostProcess::CompressCollinear(TArray<FVector>& Path)
+{
+	if (Path.Num() < 3) return;
+
+	// Out is the last kept point; reads always run ahead of writes
+	int32 Out = 0;
+	for (int32 i = 1; i < Path.Num() - 1; i++)
+	{
+		const FVector In = Path[i] - Path[Out];
+		const FVector Next = Path[i + 1] - Path[i];
+
+		// Same heading in the ground plane (grid paths are flat)
+		const bool bCollinear = FMath::Abs(In.X * Next.Y - In.Y * Next.X) <= KINDA_SMALL_NUMBER * In.Size2D() * Next.Size2D() &&
+			FVector::DotProduct(In, Next) > 0.f;
+
+		if (!bCollinear)
+		{
+			Path[++Out] = Path[i];
+		}
+	}
+	Path[++Out] = Path.Last();
+	Path.SetNum(Out + 1, EAllowShrinking::No);
+}
+
+void FPathPostProcess::StringPull(const AGridManager& Grid, TArray<FVector>& Path, int32 MaxCost, int32 MinClearance)
+{
+	if (Path.Num() < 3) return;
+
+	int32 Out = 0;
+	FIntPoint AnchorCell = Grid.WorldToCell(Path[0]);
+	MASSIVE_COUNTER_ADD(STAT_Massive_LineOfSightChecks, Path.Num() - 2);
+	for (int32 i = 1; i < Path.Num() - 1; i++)
+	{
+		// Keep Path[i] only if the anchor can't see the point after it
+		if (!Grid.HasLineOfSight(AnchorCell, Grid.WorldToCell(Path[i + 1]), MaxCost, MinClearance))
+		{
+			Path[++Out] = Path[i];
+			AnchorCell = Grid.WorldToCell(Path[i]);
+		}
+	}
+	Path[++Out] = Path.Last();
+	Path.SetNum(Out + 1, EAllowShrinking::No);
+}
+
+void FPathPostProcess::SmoothCatmullRom(const AGridManager& Grid, TArray<FVector>& Path, int32 Samples, TArray<FVector>& Scratch)
+{
+	const int32 Num = Path.Num();
+	if (Num < 3) return;
+
+	Samples = FMath::Clamp(Samples, 2, 16);
+
+	Scratch.Reset();
+	Scratch.Reserve((Num - 1) * Samples + 1);
+
+	auto IsWalkable = [&Grid](const FVector& Point)
+	{
+		const FIntPoint Cell = Grid.WorldToCell(Point);
+		return Grid.IsInside(Cell.X, Cell.Y) && Grid.IsWalkable(Grid.XYToIndex(Cell.X, Cell.Y));
+	};
+
+	for (int32 i = 0; i < Num - 1; i++)
+	{
+		// Uniform Catmull-Rom, end points are mirrored so the curve still passes through them
+		const FVector& P1 = Path[i];
+		const FVector& P2 = Path[i + 1];
+		const FVector P0 = i > 0 ? Path[i - 1] : P1 * 2.f - P2;
+		const FVector P3 = i + 2 < Num ? Path[i + 2] : P2 * 2.f - P1;
+
+		const int32 SegmentStart = Scratch.Num();
+		bool bSegmentClear = true;
+		for (int32 s = 0; s < Samples; s++)
+		{
+			const float T = float(s) / Samples;
+			const float T2 = T * T;
+			const float T3 = T2 * T;
+			const FVector Point = 0.5f * ((2.f * P1) + (P2 - P0) * T + (2.f * P0 - 5.f * P1 + 4.f * P2 - P3) * T2 +
+				(3.f * P1 - P0 - 3.f * P2 + P3) * T3);
+
+			if (!IsWalkable(Point))
+			{
+				bSegmentClear = false;
+				break;
+			}
+			Scratch.Add(Point);
+		}
+
+		// The curve bulged into a blocked cell, keep this segment straight
+		if (!bSegmentClear)
+		{
+			Scratch.SetNum(SegmentStart, EAllowShrinking::No);
+			for (int32 s = 0; s < Samples; s++)
+			{
+				Scratch.Add(FMath::Lerp(P1, P2, float(s) / Samples));
+			}
+		}
+	}
+	Scratch.Add(Path.Last());
+
+	Exchange(Path, Scratch);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathPostProcess.generated.h"
+
+class AGridManager;
+
+USTRUCT(BlueprintType)
+struct FPathPostProcessSettings
+{
+	GENERATED_BODY()
+
+	// Everything is off by default, so controllers return their raw search paths unless asked
+
+	// Drop points on straight runs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPostProcess")
+	bool bCompress = false;
+
+	// Skip waypoints the previous kept point can see past (grid line of sight)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPostProcess")
+	bool bStringPull = false;
+
+	// Shortcuts only cross cells up to this cost, so pulled paths don't cut through expensive terrain
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPostProcess", meta=(ClampMin="1", EditCondition="bStringPull"))
+	int32 MaxPullCost = 1;
+
+	// Catmull-Rom through the remaining points
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPostProcess")
+	bool bSmooth = false;
+
+	// Points per smoothed segment, including its start
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PathPostProcess", meta=(ClampMin="2", ClampMax="16", EditCondition="bSmooth"))
+	int32 SmoothingSamples = 4;
+};
+
+// Post-processing for world-space paths. Everything works in place except smoothing, which
+// writes into the caller's scratch array and swaps it in, so a reused scratch means no
+// allocations in steady state.
+struct MASSIVE_API FPathPostProcess
+{
+	// MinClearance keeps shortcuts out of gaps too narrow for the unit the path was planned for
+	static void Apply(const AGridManager& Grid, const FPathPostProcessSettings& Settings, TArray<FVector>& Path, TArray<FVector>& Scratch,
+		int32 MinClearance = 0);
+
+	static void CompressCollinear(TArray<FVector>& Path);
+	static void StringPull(const AGridManager& Grid, TArray<FVector>& Path, int32 MaxCost, int32 MinClearance = 0);
+	static void SmoothCatmullRom(const AGridManager& Grid, TArray<FVector>& Path, int32 Samples, TArray<FVector>& Scratch);
+};
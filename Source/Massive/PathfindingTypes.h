@@ -0,0 +1,465 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathfindingTypes.generated.h"
+
+// Priority queue used for a search's open list
+UENUM(BlueprintType)
+enum class EPathOpenListType : uint8
+{
+	BinaryHeap,
+	QuaternaryHeap,
+	// Exact only when move costs are integral (see FBucketOpenSet)
+	BucketQueue
+};
+
+// Per-node search state: G plus parent index with the closed flag packed into its top bit.
+// H and F are not stored, F lives in the open list and H is recomputed when needed.
+struct FSearchNode
+{
+	static constexpr uint32 ClosedBit = 1u << 31;
+	static constexpr uint32 NoParent = ~ClosedBit;
+
+	float G = TNumericLimits<float>::Max(); // cost from start
+	uint32 ParentAndClosed = NoParent;
+
+	FORCEINLINE int32 GetParent() const
+	{
+		const uint32 Parent = ParentAndClosed & ~ClosedBit;
+		return Parent == NoParent ? -1 : int32(Parent);
+	}
+
+	FORCEINLINE void SetParent(int32 Parent)
+	{
+		ParentAndClosed = (ParentAndClosed & ClosedBit) | (Parent < 0 ? NoParent : uint32(Parent));
+	}
+
+	FORCEINLINE bool IsClosed() const { return (ParentAndClosed & ClosedBit) != 0; }
+
+	FORCEINLINE void SetClosed(bool bClosed)
+	{
+		ParentAndClosed = bClosed ? (ParentAndClosed | ClosedBit) : (ParentAndClosed & ~ClosedBit);
+	}
+};
+static_assert(sizeof(FSearchNode) == 8, "FSearchNode should stay 8 bytes");
+
+struct FOpenSetItem
+{
+	int32 NodeIndex;
+	float F;
+};
+
+// All open lists share this interface so the search loop can be templated on them:
+// Init, IsEmpty, Num, Push, PopMin, PushOrDecrease, Contains, Remove, PeekMinF.
+
+// Open set (binary heap with positions for decrease-key)
+struct FBinaryHeapOpenSet
+{
+	void Init(int32 NumNodes)
+	{
+		Heap.Reset();
+		Pos.Init(-1, NumNodes);
+	}
+
+	bool IsEmpty() const { return Heap.Num() == 0; }
+
+	int32 Num() const { return Heap.Num(); }
+
+	void Push(int32 NodeIndex, float FVal)
+	{
+		FOpenSetItem Item{ NodeIndex, FVal };
+		Heap.Add(Item);
+		int32 i = Heap.Num() - 1;
+		Pos[NodeIndex] = i;
+		SiftUp(i);
+	}
+
+	int32 PopMin()
+	{
+		float Key;
+		return PopMin(Key);
+	}
+
+	int32 PopMin(float& OutKey)
+	{
+		if (Heap.Num() == 0) return -1;
+		int32 Best = Heap[0].NodeIndex;
+		OutKey = Heap[0].F;
+		SwapNodes(0, Heap.Num() - 1);
+		Pos[Best] = -1;
+		Heap.Pop(EAllowShrinking::No);
+		if (Heap.Num() > 0) SiftDown(0);
+		return Best;
+	}
+
+	void PushOrDecrease(int32 NodeIndex, float NewF)
+	{
+		if (NodeIndex < 0 || NodeIndex >= Pos.Num()) return;
+		int32 p = Pos[NodeIndex];
+		if (p == -1)
+		{
+			Push(NodeIndex, NewF);
+		}
+		else
+		{
+			if (NewF < Heap[p].F)
+			{
+				Heap[p].F = NewF;
+				SiftUp(p);
+			}
+		}
+	}
+
+	bool Contains(int32 NodeIndex) const { return Pos.IsValidIndex(NodeIndex) && Pos[NodeIndex] != -1; }
+
+	float PeekMinF() const { return Heap.Num() > 0 ? Heap[0].F : TNumericLimits<float>::Max(); }
+
+	void Remove(int32 NodeIndex)
+	{
+		if (!Contains(NodeIndex)) return;
+		const int32 p = Pos[NodeIndex];
+		const int32 Last = Heap.Num() - 1;
+		SwapNodes(p, Last);
+		Pos[NodeIndex] = -1;
+		Heap.Pop(EAllowShrinking::No);
+		if (p < Heap.Num())
+		{
+			// The former last item now sits at p and may need to move either way
+			const int32 Moved = Heap[p].NodeIndex;
+			SiftUp(p);
+			SiftDown(Pos[Moved]);
+		}
+	}
+
+	SIZE_T GetAllocatedSize() const { return Heap.GetAllocatedSize() + Pos.GetAllocatedSize(); }
+
+private:
+	TArray<FOpenSetItem> Heap;
+	TArray<int32> Pos;
+
+	void SwapNodes(int32 A, int32 B)
+	{
+		if (A == B) return;
+		Exchange(Heap[A], Heap[B]);
+		Pos[Heap[A].NodeIndex] = A;
+		Pos[Heap[B].NodeIndex] = B;
+	}
+
+	void SiftUp(int32 i)
+	{
+		while (i > 0)
+		{
+			int32 Parent = (i - 1) >> 1;
+			if (Heap[i].F < Heap[Parent].F)
+			{
+				SwapNodes(i, Parent);
+				i = Parent;
+			}
+			else break;
+		}
+	}
+
+	void SiftDown(int32 i)
+	{
+		const int32 N = Heap.Num();
+		while (true)
+		{
+			int32 Left = i * 2 + 1;
+			int32 Right = Left + 1;
+			int32 Smallest = i;
+			if (Left < N && Heap[Left].F < Heap[Smallest].F) Smallest = Left;
+			if (Right < N && Heap[Right].F < Heap[Smallest].F) Smallest = Right;
+			if (Smallest != i) { SwapNodes(i, Smallest); i = Smallest; }
+			else break;
+		}
+	}
+};
+
+// 4-ary heap with decrease-key. Half the depth of a binary heap, and the four children
+// of any item sit in one aligned 32-byte block, so each level of a sift is one cache line.
+// Sifts move a hole instead of swapping, so positions are written once per level.
+struct FQuaternaryHeapOpenSet
+{
+	void Init(int32 NumNodes)
+	{
+		// Logical item i lives at Heap[i + RootOffset]; the padding puts every sibling group on a 4-item boundary
+		Heap.Reset();
+		Heap.AddZeroed(RootOffset);
+		Pos.Init(-1, NumNodes);
+	}
+
+	bool IsEmpty() const { return Num() == 0; }
+
+	int32 Num() const { return FMath::Max(0, Heap.Num() - RootOffset); }
+
+	void Push(int32 NodeIndex, float FVal)
+	{
+		Heap.AddUninitialized();
+		SiftUp(Num() - 1, FOpenSetItem{ NodeIndex, FVal });
+	}
+
+	int32 PopMin()
+	{
+		float Key;
+		return PopMin(Key);
+	}
+
+	int32 PopMin(float& OutKey)
+	{
+		if (IsEmpty()) return -1;
+		const FOpenSetItem Best = At(0);
+		OutKey = Best.F;
+		Pos[Best.NodeIndex] = -1;
+
+		const FOpenSetItem Last = Heap.Pop(EAllowShrinking::No);
+		if (!IsEmpty()) SiftDown(0, Last);
+		return Best.NodeIndex;
+	}
+
+	void PushOrDecrease(int32 NodeIndex, float NewF)
+	{
+		if (NodeIndex < 0 || NodeIndex >= Pos.Num()) return;
+		const int32 p = Pos[NodeIndex];
+		if (p == -1)
+		{
+			Push(NodeIndex, NewF);
+		}
+		else if (NewF < At(p).F)
+		{
+			SiftUp(p, FOpenSetItem{ NodeIndex, NewF });
+		}
+	}
+
+	bool Contains(int32 NodeIndex) const { return Pos.IsValidIndex(NodeIndex) && Pos[NodeIndex] != -1; }
+
+	float PeekMinF() const { return IsEmpty() ? TNumericLimits<float>::Max() : At(0).F; }
+
+	void Remove(int32 NodeIndex)
+	{
+		if (!Contains(NodeIndex)) return;
+		const int32 p = Pos[NodeIndex];
+		Pos[NodeIndex] = -1;
+
+		const FOpenSetItem Last = Heap.Pop(EAllowShrinking::No);
+		if (p < Num())
+		{
+			// Refill the hole with the old last item, which may need to move either way
+			if (p > 0 && Last.F < At((p - 1) >> 2).F) SiftUp(p, Last);
+			else SiftDown(p, Last);
+		}
+	}
+
+	SIZE_T GetAllocatedSize() const { return Heap.GetAllocatedSize() + Pos.GetAllocatedSize(); }
+
+private:
+	static constexpr int32 RootOffset = 3;
+
+	TArray<FOpenSetItem, TAlignedHeapAllocator<64>> Heap;
+	TArray<int32> Pos;
+
+	FORCEINLINE FOpenSetItem& At(int32 i) { return Heap[i + RootOffset]; }
+	FORCEINLINE const FOpenSetItem& At(int32 i) const { return Heap[i + RootOffset]; }
+
+	FORCEINLINE void Place(int32 i, const FOpenSetItem& Item)
+	{
+		At(i) = Item;
+		Pos[Item.NodeIndex] = i;
+	}
+
+	void SiftUp(int32 i, const FOpenSetItem& Item)
+	{
+		while (i > 0)
+		{
+			const int32 Parent = (i - 1) >> 2;
+			if (!(Item.F < At(Parent).F)) break;
+			Place(i, At(Parent));
+			i = Parent;
+		}
+		Place(i, Item);
+	}
+
+	void SiftDown(int32 i, const FOpenSetItem& Item)
+	{
+		const int32 N = Num();
+		while (true)
+		{
+			const int32 First = i * 4 + 1;
+			if (First >= N) break;
+
+			int32 Smallest = First;
+			const int32 End = FMath::Min(First + 4, N);
+			for (int32 c = First + 1; c < End; c++)
+			{
+				if (At(c).F < At(Smallest).F) Smallest = c;
+			}
+
+			if (!(At(Smallest).F < Item.F)) break;
+			Place(i, At(Smallest));
+			i = Smallest;
+		}
+		Place(i, Item);
+	}
+};
+
+// Bucket queue (Dial's algorithm) keyed by floor(F / BucketWidth). The buckets form a ring that
+// only has to span the open F values (from the lowest to the highest), so memory grows with that
+// spread rather than with path cost; the ring doubles when a key falls outside it.
+// A pop returns a node whose F is less than the smallest open F plus BucketWidth. FAStarSearch
+// reopens closed nodes on this list, so when the goal is popped an open node on an optimal path
+// still bounds it, and the path costs at most C* + BucketWidth for plain A* (HeuristicWeight 1).
+// Exact when all F values are multiples of BucketWidth (integral costs with DiagonalCost 1 or 2
+// and BucketWidth 1). Decrease-key is lazy: stale entries stay in their old bucket and are
+// skipped when reached.
+struct FBucketOpenSet
+{
+	void Init(int32 NumNodes, float InBucketWidth = 1.f)
+	{
+		for (TArray<int32>& Bucket : Buckets) Bucket.Reset();
+		if (Buckets.Num() == 0) Buckets.SetNum(MinBuckets);
+		Keys.Init(-1.f, NumNodes);
+		KeyBuckets.SetNumUninitialized(NumNodes);
+		BucketWidth = FMath::Max(InBucketWidth, KINDA_SMALL_NUMBER);
+		InvBucketWidth = 1.f / BucketWidth;
+		Cursor = 0;
+		Count = 0;
+	}
+
+	bool IsEmpty() const { return Count == 0; }
+
+	int32 Num() const { return Count; }
+
+	void Push(int32 NodeIndex, float FVal)
+	{
+		// Only stale entries can be left, and the new key may be anywhere relative to them
+		if (Count == 0)
+		{
+			for (TArray<int32>& Bucket : Buckets) Bucket.Reset();
+			Cursor = FMath::FloorToInt(FVal * InvBucketWidth);
+		}
+
+		Keys[NodeIndex] = FVal;
+		AddEntry(NodeIndex, FVal, false);
+		Count++;
+	}
+
+	int32 PopMin()
+	{
+		float Key;
+		return PopMin(Key);
+	}
+
+	int32 PopMin(float& OutKey)
+	{
+		if (!AdvanceCursor()) return -1;
+		const int32 Node = Buckets[Cursor & Mask()].Pop(EAllowShrinking::No);
+		OutKey = Keys[Node];
+		Keys[Node] = -1.f;
+		Count--;
+		return Node;
+	}
+
+	void PushOrDecrease(int32 NodeIndex, float NewF)
+	{
+		if (NodeIndex < 0 || NodeIndex >= Keys.Num()) return;
+		if (Keys[NodeIndex] < 0.f)
+		{
+			Push(NodeIndex, NewF);
+		}
+		else if (NewF < Keys[NodeIndex])
+		{
+			Keys[NodeIndex] = NewF;
+			AddEntry(NodeIndex, NewF, true);
+		}
+	}
+
+	bool Contains(int32 NodeIndex) const { return Keys.IsValidIndex(NodeIndex) && Keys[NodeIndex] >= 0.f; }
+
+	// Lower edge of the lowest non-empty bucket, a lower bound on the smallest F
+	float PeekMinF()
+	{
+		if (!AdvanceCursor()) return TNumericLimits<float>::Max();
+		return float(Cursor) * BucketWidth;
+	}
+
+	void Remove(int32 NodeIndex)
+	{
+		if (!Contains(NodeIndex)) return;
+		Keys[NodeIndex] = -1.f;
+		Count--;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = Buckets.GetAllocatedSize() + Keys.GetAllocatedSize() + KeyBuckets.GetAllocatedSize();
+		for (const TArray<int32>& Bucket : Buckets) Size += Bucket.GetAllocatedSize();
+		return Size;
+	}
+
+private:
+	static constexpr int32 MinBuckets = 64;
+
+	// Ring of buckets, a power of two long. Absolute bucket b lives at Buckets[b & Mask()].
+	// Kept across Init so bucket storage is reused between queries.
+	TArray<TArray<int32>> Buckets;
+	TArray<float> Keys;        // current key per node, < 0 when not in the set
+	TArray<int32> KeyBuckets;  // absolute bucket of the node's live entry, only read while in the set
+	float BucketWidth = 1.f;
+	float InvBucketWidth = 1.f;
+	int32 Cursor = 0;          // absolute bucket of the lowest possibly non-empty slot
+	int32 Count = 0;
+
+	FORCEINLINE int32 Mask() const { return Buckets.Num() - 1; }
+
+	FORCEINLINE bool IsLiveEntry(int32 Node, int32 Bucket) const
+	{
+		return Keys[Node] >= 0.f && KeyBuckets[Node] == Bucket;
+	}
+
+	void AddEntry(int32 NodeIndex, float Key, bool bHasLiveEntry)
+	{
+		// Keys below the cursor (inconsistent heuristics, reopened nodes) join the current bucket,
+		// which still pops them within a bucket width of the minimum
+		const int32 b = FMath::Max(Cursor, FMath::FloorToInt(Key * InvBucketWidth));
+		if (bHasLiveEntry && KeyBuckets[NodeIndex] == b) return;
+
+		if (b - Cursor >= Buckets.Num()) Grow(b - Cursor + 1);
+
+		KeyBuckets[NodeIndex] = b;
+		Buckets[b & Mask()].Add(NodeIndex);
+	}
+
+	// Resizes the ring to span at least NumNeeded buckets from the cursor, dropping stale entries
+	void Grow(int32 NumNeeded)
+	{
+		TArray<TArray<int32>> OldBuckets = MoveTemp(Buckets);
+		const int32 OldMask = OldBuckets.Num() - 1;
+
+		Buckets.SetNum(FMath::RoundUpToPowerOfTwo(FMath::Max(NumNeeded, OldBuckets.Num() * 2)));
+		for (int32 b = Cursor; b <= Cursor + OldMask; b++)
+		{
+			for (const int32 Node : OldBuckets[b & OldMask])
+			{
+				if (IsLiveEntry(Node, b)) Buckets[b & Mask()].Add(Node);
+			}
+		}
+	}
+
+	// Moves the cursor to the first bucket with a live entry on top. Slots behind the cursor
+	// are always empty, so every live entry stays within one ring length of it.
+	bool AdvanceCursor()
+	{
+		if (Count == 0) return false;
+		while (true)
+		{
+			TArray<int32>& Bucket = Buckets[Cursor & Mask()];
+
+			// Drop stale entries from the back so the next pop is live
+			while (Bucket.Num() > 0 && !IsLiveEntry(Bucket.Last(), Cursor))
+			{
+				Bucket.Pop(EAllowShrinking::No);
+			}
+			if (Bucket.Num() > 0) return true;
+			Cursor++;
+		}
+	}
+};
@@ -1,4 +1,6 @@
 #include "ThetaStarController.h"
+#include "MassiveStats.h"
+#include "Misc/ScopeExit.h"
 #include "DrawDebugHelpers.h"
 #include "Components/LineBatchComponent.h"
 #include "Engine/World.h"
@@ -46,10 +48,13 @@ float AThetaStarController::MovementCostBetween(int32 AIndex, int32 BIndex) cons
 	int Dy = FMath::Abs(Ay - By);
 
 	if (Dx + Dy == 1) return 1.f;
-	return DiagonalCost;
+	if (Dx == 1 && Dy == 1) return DiagonalCost;
+
+	// Line of sight shortcut, any angle
+	return FMath::Sqrt(float(Dx * Dx + Dy * Dy));
 }
 
-TArray<FVector> AThetaStarController::FindPath(const FVector& StartWorld, const FVector& GoalWorld)
+TArray<FVector> AThetaStarController::FindPath(const FVector& StartWorld, const FVector& GoalWorld, float UnitRadius)
 {
 	// Convert to grid space
 	FIntPoint StartCell = GridManager->WorldToCell(StartWorld);
@@ -68,7 +73,8 @@ TArray<FVector> AThetaStarController::FindPath(const FVector& StartWorld, const
 	}
 
 	// Run the Theta* core (this part can stay private, taking FIntPoints)
-	TArray<FIntPoint> CellPath = RunThetaStar(StartCell, GoalCell);
+	const int32 MinClearance = UnitRadius > 0.f ? GridManager->RadiusToClearance(UnitRadius) : 0;
+	TArray<FIntPoint> CellPath = RunThetaStar(StartCell, GoalCell, MinClearance);
 
 	// Convert back to world space
 	TArray<FVector> WorldPath;
@@ -76,6 +82,7 @@ TArray<FVector> AThetaStarController::FindPath(const FVector& StartWorld, const
 	{
 		WorldPath.Add(GridManager->CellToWorld(Cell));
 	}
+	GridManager->PostProcessPath(WorldPath, PathPostProcess, UnitRadius);
 
 	// Optional debug draw
 	if (GridManager->bDrawDebug && GridManager->bDrawThetaStarPath)
@@ -112,9 +119,21 @@ TArray<FVector> AThetaStarController::FindPath(const FVector& StartWorld, const
 	return WorldPath;
 }
 
-TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell, const FIntPoint& GoalCell)
+TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell, const FIntPoint& GoalCell, int32 MinClearance)
 {
+    MASSIVE_SCOPE_CYCLE_COUNTER(STAT_Massive_ThetaStar);
+
     TArray<FIntPoint> ResultPath;
+    LastNodesExpanded = 0;
+
+    int32 HeapOperations = 0;
+    int32 LineOfSightChecks = 0;
+    ON_SCOPE_EXIT
+    {
+        MASSIVE_COUNTER_ADD(STAT_Massive_NodesExpanded, LastNodesExpanded);
+        MASSIVE_COUNTER_ADD(STAT_Massive_HeapOperations, HeapOperations);
+        MASSIVE_COUNTER_ADD(STAT_Massive_LineOfSightChecks, LineOfSightChecks);
+    };
 
     // Validate cells in-bounds
     if (!GridManager->IsInside(StartCell.X, StartCell.Y) || !GridManager->IsInside(GoalCell.X, GoalCell.Y))
@@ -134,21 +153,37 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
 
     const int32 NumNodes = GridManager->GridWidth * GridManager->GridHeight;
 
-    // Search buffers
+    // Search buffers (default-constructed nodes are already "unvisited")
+    LLM_SCOPE_BYTAG(Massive_Search);
     TArray<FSearchNode> SearchNodes;
     SearchNodes.SetNum(NumNodes);
-    for (int32 i = 0; i < NumNodes; ++i)
+
+    FQuaternaryHeapOpenSet OpenSet;
+    OpenSet.Init(NumNodes);
+
+    FMassiveMemoryCounter SearchMemory(EMassiveMemory::Search);
+    SearchMemory.Set(SearchNodes.GetAllocatedSize() + OpenSet.GetAllocatedSize());
+
+    // ALT landmark bound for the goal, if the grid has up to date landmarks.
+    // Landmark distances are 8-connected grid distances, so for any-angle paths they
+    // can overestimate slightly; Theta* paths aren't optimal anyway and it prunes a lot.
+    TSharedPtr<const FGridLandmarks> Landmarks = bUseLandmarkHeuristic ? GridManager->GetLandmarks() : nullptr;
+    if (Landmarks.IsValid() && Landmarks->GetDiagonalCost() > DiagonalCost)
     {
-        SearchNodes[i].G = TNumericLimits<float>::Max();
-        SearchNodes[i].H = 0.f;
-        SearchNodes[i].F = TNumericLimits<float>::Max();
-        SearchNodes[i].Parent = -1;
-        SearchNodes[i].bClosed = false;
+        Landmarks.Reset();
     }
+    const FGridLandmarks::FGoal LandmarkGoal = Landmarks.IsValid() ? Landmarks->MakeGoal(GoalIdx) : FGridLandmarks::FGoal();
 
-    FBinaryHeapOpenSet OpenSet;
-    OpenSet.ReservePos(NumNodes);
-    OpenSet.Init(NumNodes);
+    // Shortcuts must not squeeze a large unit through a gap the neighbor filter kept it out of.
+    // A shortcut is charged at the cost of the cell it ends on, so it may only cross cells that
+    // cost no more than that; otherwise it would pass through expensive terrain for free.
+    auto HasShortcut = [&](int32 From, int32 To, int32 MaxCost) -> bool
+    {
+        int32 FX, FY, TX, TY;
+        IndexToXY(From, FX, FY);
+        IndexToXY(To, TX, TY);
+        return GridManager->HasLineOfSight(FIntPoint(FX, FY), FIntPoint(TX, TY), MaxCost, MinClearance);
+    };
 
     // Octile heuristic (admissible/consistent for 8-way with DiagonalCost)
     auto Heuristic = [&](int32 A, int32 B) -> float
@@ -159,14 +194,13 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
         const int32 Dx = FMath::Abs(Ax - Bx);
         const int32 Dy = FMath::Abs(Ay - By);
         const float F  = float(FMath::Min(Dx, Dy));
-        return float(FMath::Max(Dx, Dy) - F) + DiagonalCost * F;
+        const float Octile = float(FMath::Max(Dx, Dy) - F) + DiagonalCost * F;
+        return Landmarks.IsValid() ? FMath::Max(Octile, Landmarks->Heuristic(A, LandmarkGoal)) : Octile;
     };
 
     // Initialize start
     SearchNodes[StartIdx].G = 0.f;
-    SearchNodes[StartIdx].H = Heuristic(StartIdx, GoalIdx);
-    SearchNodes[StartIdx].F = SearchNodes[StartIdx].H; // G=0 so F=H
-    OpenSet.Push(StartIdx, SearchNodes[StartIdx].F);
+    OpenSet.Push(StartIdx, Heuristic(StartIdx, GoalIdx)); // G=0 so F=H
 
     bool bFound = false;
 
@@ -174,6 +208,7 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
     {
         const int32 Curr = OpenSet.PopMin();
         if (Curr == -1) break;
+        HeapOperations++;
 
         if (Curr == GoalIdx)
         {
@@ -182,7 +217,8 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
         }
 
         // Mark closed
-        SearchNodes[Curr].bClosed = true;
+        SearchNodes[Curr].SetClosed(true);
+        LastNodesExpanded++;
 
     	int32 CurrX, CurrY;
     	IndexToXY(Curr, CurrX, CurrY);
@@ -192,23 +228,24 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
     	for (const FGridCell* NbCell : Neighbors)
     	{
     		const int32 Nb = GridManager->XYToIndex(NbCell->X, NbCell->Y);
-    		if (SearchNodes[Nb].bClosed) continue;
+    		if (SearchNodes[Nb].IsClosed()) continue;
+    		if (MinClearance > 1 && Nb != GoalIdx && GridManager->GetClearance(Nb) < MinClearance) continue;
 
     		float TerrainCost = (GridManager->Grid.IsValidIndex(Nb) ? FMath::Max(1, GridManager->Grid[Nb].Cost) : 1);
     		float MoveCost = MovementCostBetween(Curr, Nb);
     
     		// Lazy Theta*: Attempt to connect neighbor to parent of current if LOS exists
-    		int32 ParentIdx = SearchNodes[Curr].Parent;
-    		if (ParentIdx != -1 && HasLineOfSight(ParentIdx, Nb))
+    		int32 ParentIdx = SearchNodes[Curr].GetParent();
+    		if (ParentIdx != -1) LineOfSightChecks++;
+    		if (ParentIdx != -1 && HasShortcut(ParentIdx, Nb, int32(TerrainCost)))
     		{
     			float TentativeG = SearchNodes[ParentIdx].G + MovementCostBetween(ParentIdx, Nb) * TerrainCost;
     			if (TentativeG < SearchNodes[Nb].G)
     			{
-    				SearchNodes[Nb].Parent = ParentIdx;
+    				SearchNodes[Nb].SetParent(ParentIdx);
     				SearchNodes[Nb].G = TentativeG;
-    				SearchNodes[Nb].H = Heuristic(Nb, GoalIdx);
-    				SearchNodes[Nb].F = SearchNodes[Nb].G + SearchNodes[Nb].H;
-    				OpenSet.PushOrDecrease(Nb, SearchNodes[Nb].F);
+    				OpenSet.PushOrDecrease(Nb, TentativeG + Heuristic(Nb, GoalIdx));
+    				HeapOperations++;
     			}
     		}
     		else
@@ -217,11 +254,10 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
     			float TentativeG = SearchNodes[Curr].G + MoveCost * TerrainCost;
     			if (TentativeG < SearchNodes[Nb].G)
     			{
-    				SearchNodes[Nb].Parent = Curr;
+    				SearchNodes[Nb].SetParent(Curr);
     				SearchNodes[Nb].G = TentativeG;
-    				SearchNodes[Nb].H = Heuristic(Nb, GoalIdx);
-    				SearchNodes[Nb].F = SearchNodes[Nb].G + SearchNodes[Nb].H;
-    				OpenSet.PushOrDecrease(Nb, SearchNodes[Nb].F);
+    				OpenSet.PushOrDecrease(Nb, TentativeG + Heuristic(Nb, GoalIdx));
+    				HeapOperations++;
     			}
     		}
     	}
@@ -236,7 +272,7 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
         while (Trace != -1)
         {
             PathIdx.Add(Trace);
-            Trace = SearchNodes[Trace].Parent;
+            Trace = SearchNodes[Trace].GetParent();
         }
         Algo::Reverse(PathIdx);
 
@@ -254,34 +290,12 @@ TArray<FIntPoint> AThetaStarController::RunThetaStar(const FIntPoint& StartCell,
 
 bool AThetaStarController::HasLineOfSight(int32 FromIdx, int32 ToIdx) const
 {
+	if (!GridManager) return false;
+
 	int32 X0, Y0, X1, Y1;
 	IndexToXY(FromIdx, X0, Y0);
 	IndexToXY(ToIdx, X1, Y1);
 
-	// Bresenham's line algorithm (grid-based)
-	int32 Dx = FMath::Abs(X1 - X0);
-	int32 Dy = FMath::Abs(Y1 - Y0);
-
-	int32 SX = (X0 < X1) ? 1 : -1;
-	int32 SY = (Y0 < Y1) ? 1 : -1;
-
-	int32 Err = Dx - Dy;
-
-	int X = X0;
-	int Y = Y0;
-
-	while (true)
-	{
-		int32 Idx = GridManager->XYToIndex(X, Y);
-		if (!GridManager->Grid.IsValidIndex(Idx) || !GridManager->Grid[GridManager->XYToIndex(X, Y)].bIsBlocked)
-			return false;
-
-		if (X == X1 && Y == Y1) break;
-
-		int32 E2 = 2 * Err;
-		if (E2 > -Dy) { Err -= Dy; X += SX; }
-		if (E2 <  Dx) { Err += Dx; Y += SY; }
-	}
-
-	return true;
-}
\ No newline at end of file
+	// Same test the path post-processing uses, so searches and string pulling agree
+	return GridManager->HasLineOfSight(FIntPoint(X0, Y0), FIntPoint(X1, Y1));
+}